@@ -0,0 +1,97 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { PerformanceObserver } = require('perf_hooks');
+
+// 解析器复用的基准：对 N 个小文件（默认 10000）分别按
+//   per-file：每个文件新建全部检测器（每个检测器各自创建原生解析器并各自解析一遍）
+//   pooled：  一个 AnalysisEngine，检测器共享一个解析器，每个文件只解析一次
+// 两种方式分析，比较耗时、GC 次数与 GC 耗时。需要先 npm run compile。
+// 用法: node scripts/bench_parser_pool.js [文件数]
+
+const out = path.resolve(__dirname, '..', 'out');
+const { AnalysisEngine } = require(path.join(out, 'core/engine'));
+const { StandaloneASTVariableDetector } = require(path.join(out, 'detectors/standalone_ast_variable_detector'));
+const { StandaloneASTLibraryDetector } = require(path.join(out, 'detectors/standalone_ast_library_detector'));
+const { StandaloneASTAdvancedDetector } = require(path.join(out, 'detectors/standalone_ast_advanced_detector'));
+const { StandaloneASTPerformanceDetector } = require(path.join(out, 'detectors/standalone_ast_performance_detector'));
+const { StandaloneASTConcurrencyDetector } = require(path.join(out, 'detectors/standalone_ast_concurrency_detector'));
+
+function generate(dir, count) {
+  fs.mkdirSync(dir, { recursive: true });
+  const files = [];
+  for (let i = 0; i < count; i++) {
+    const file = path.join(dir, `unit_${i}.c`);
+    const code = `#include <stdio.h>\n#include <stdlib.h>\n\nstatic int table_${i}[16];\n\n` +
+      `int sum_${i}(int n) {\n  int total = 0;\n  for (int k = 0; k < n; k++) {\n    total += table_${i}[k % 16];\n  }\n  return total;\n}\n\n` +
+      `int main(void) {\n  int *p = malloc(sizeof(int) * 4);\n  int x;\n  printf("%d\\n", sum_${i}(${i % 50}) + x);\n  return p ? 0 : 1;\n}\n`;
+    fs.writeFileSync(file, code, 'utf8');
+    files.push(file);
+  }
+  return files;
+}
+
+async function measure(label, files, analyzeFile) {
+  const gc = { count: 0, ms: 0 };
+  const observer = new PerformanceObserver(list => {
+    for (const entry of list.getEntries()) {
+      gc.count++;
+      gc.ms += entry.duration;
+    }
+  });
+  observer.observe({ entryTypes: ['gc'] });
+
+  if (global.gc) global.gc();
+  const heapBefore = process.memoryUsage().heapUsed;
+  const started = process.hrtime.bigint();
+  let issues = 0;
+  for (const file of files) {
+    issues += (await analyzeFile(file, fs.readFileSync(file, 'utf8'))).length;
+  }
+  const elapsed = Number(process.hrtime.bigint() - started) / 1e6;
+  // 让最后一批 GC 事件送达
+  await new Promise(resolve => setImmediate(resolve));
+  observer.disconnect();
+  const heapAfter = process.memoryUsage().heapUsed;
+
+  console.log(`${label.padEnd(9)} ${elapsed.toFixed(0).padStart(8)} ms  ` +
+    `GC ${String(gc.count).padStart(5)} 次 ${gc.ms.toFixed(0).padStart(6)} ms  ` +
+    `堆 ${((heapAfter - heapBefore) / 1048576).toFixed(1).padStart(7)} MB  问题 ${issues}`);
+}
+
+async function main() {
+  const count = parseInt(process.argv[2], 10) || 10000;
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'cscan-bench-'));
+  try {
+    const files = generate(dir, count);
+    console.log(`${count} 个小文件，位于 ${dir}`);
+
+    await measure('per-file', files, async (file, source) => {
+      const detectors = {
+        variable: new StandaloneASTVariableDetector(),
+        library: new StandaloneASTLibraryDetector(),
+        advanced: new StandaloneASTAdvancedDetector(),
+        performance: new StandaloneASTPerformanceDetector(),
+        concurrency: new StandaloneASTConcurrencyDetector()
+      };
+      return [
+        ...await detectors.variable.analyzeFile(file, source),
+        ...await detectors.library.analyzeFile(file, source),
+        ...await detectors.library.checkHeaderSpelling(file, source),
+        ...await detectors.advanced.analyzeFile(file, source),
+        ...await detectors.performance.analyzeFile(file, source),
+        ...await detectors.concurrency.analyzeFile(file, source)
+      ];
+    });
+
+    const engine = new AnalysisEngine();
+    await measure('pooled', files, (file, source) => engine.analyzeSource(file, source));
+  } finally {
+    fs.rmSync(dir, { recursive: true, force: true });
+  }
+}
+
+main().catch(error => {
+  console.error(error);
+  process.exit(1);
+});
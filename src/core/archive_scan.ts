@@ -0,0 +1,83 @@
+import * as os from 'os';
+import * as path from 'path';
+import { IssueRecord } from './engine';
+import { blobId } from './git_source';
+import { ResultCache } from './result_cache';
+import { BlobAnalyzer } from './revision_scan';
+import { openArchiveStream, readTarEntries } from './tar_reader';
+
+// 超过此大小的条目不当作源文件读入内存（生成的数据表等）
+const MAX_SOURCE_BYTES = 8 * 1024 * 1024;
+
+export interface ArchiveScanOptions {
+  extensions?: string[];    // 默认 ['.c', '.h']
+  jobs?: number;            // 并行工作线程数，默认 CPU 核数
+  cache?: ResultCache;
+}
+
+export interface ArchiveScanStats {
+  files: number;
+  cached: number;
+  skipped: number;          // 过大而跳过的文件
+}
+
+/**
+ * 流式扫描源码归档（.tar/.tar.gz，以及有本地解码器时的 .tar.xz/.tar.bz2/.tar.zst），不解压到磁盘
+ * 条目逐个从解压流中读出，命中内容哈希缓存的直接返回结果，其余交给分析引擎（工作线程池）；
+ * 同时在分析中的文件不超过 jobs × 2 个，读取会等待分析跟上，内存占用与归档大小无关
+ * 内容哈希与 git blob ID 的算法相同，同一文件来自归档或 git 对象库时共用缓存
+ * 问题记录中的文件路径为 <归档路径>/<条目路径>
+ */
+export async function* scanArchive(archivePath: string, options: ArchiveScanOptions = {},
+                                   stats: ArchiveScanStats = { files: 0, cached: 0, skipped: 0 }): AsyncIterable<IssueRecord> {
+  const extensions = options.extensions || ['.c', '.h'];
+  const cache = options.cache || new ResultCache();
+  const jobs = Math.max(1, options.jobs || os.cpus().length);
+  const analyzer = new BlobAnalyzer(path.dirname(archivePath), cache, jobs);
+
+  const want = (entryPath: string, size: number) => {
+    if (!extensions.some(ext => entryPath.endsWith(ext))) return false;
+    if (size > MAX_SOURCE_BYTES) {
+      stats.skipped++;
+      return false;
+    }
+    return true;
+  };
+
+  const pending = new Map<number, Promise<{ index: number; issues: IssueRecord[] }>>();
+  let next = 0;
+  try {
+    for await (const entry of readTarEntries(openArchiveStream(archivePath), want)) {
+      stats.files++;
+      const file = path.join(archivePath, entry.path);
+      const hash = blobId(entry.content);
+      const cached = cache.get(hash, file);
+      if (cached) {
+        stats.cached++;
+        yield* cached;
+        continue;
+      }
+
+      const index = next++;
+      pending.set(index, analyzer.analyzeContent(file, entry.content.toString('utf8'), hash)
+        .catch((error): IssueRecord[] => {
+          console.error(`分析 ${file} 时发生错误:`, error.message);
+          return [];
+        })
+        .then(issues => ({ index, issues })));
+
+      if (pending.size >= jobs * 2) {
+        const done = await Promise.race(pending.values());
+        pending.delete(done.index);
+        yield* done.issues;
+      }
+    }
+    while (pending.size > 0) {
+      const done = await Promise.race(pending.values());
+      pending.delete(done.index);
+      yield* done.issues;
+    }
+  } finally {
+    await analyzer.close();
+  }
+}
@@ -0,0 +1,392 @@
+import * as fs from 'fs';
+import { Issue } from '../interfaces/types';
+import { issueFingerprint } from './fingerprint';
+
+/**
+ * Apache Arrow IPC 流格式（Streaming Format）的最小写入器，不依赖 arrow 库
+ * 元数据按 Arrow 的 Schema.fbs / Message.fbs 手工编码为 flatbuffer
+ */
+
+const CONTINUATION = 0xffffffff;
+const METADATA_V5 = 4;
+
+// MessageHeader 联合体
+const HEADER_SCHEMA = 1;
+const HEADER_DICTIONARY_BATCH = 2;
+const HEADER_RECORD_BATCH = 3;
+
+// Type 联合体
+const TYPE_INT = 2;
+const TYPE_UTF8 = 5;
+
+type ColumnKind = 'dictionary' | 'utf8' | 'int32' | 'int8';
+
+interface ColumnSpec {
+  name: string;
+  kind: ColumnKind;
+  dictionaryId?: number;
+}
+
+// 列：文件、类别、消息模板按字典编码（跨批次共享字典，新值以增量字典批次追加）
+const COLUMNS: ColumnSpec[] = [
+  { name: 'file', kind: 'dictionary', dictionaryId: 0 },
+  { name: 'category', kind: 'dictionary', dictionaryId: 1 },
+  { name: 'message_template', kind: 'dictionary', dictionaryId: 2 },
+  { name: 'message', kind: 'utf8' },
+  { name: 'line', kind: 'int32' },
+  { name: 'column', kind: 'int32' },
+  { name: 'severity', kind: 'int8' },
+  { name: 'fingerprint', kind: 'utf8' }
+];
+
+/**
+ * 消息模板：去掉引号中的名字和数字，同一类消息归为一个字典值
+ * 例如 "变量 'count' 在初始化前被使用" → "变量 '?' 在初始化前被使用"
+ */
+export function messageTemplate(message: string): string {
+  return message
+    .replace(/'[^']*'/g, '\'?\'')
+    .replace(/"[^"]*"/g, '"?"')
+    .replace(/-?\d+(?:\.\d+)?/g, '#');
+}
+
+/**
+ * 把扫描结果写成 Arrow IPC 流：先写 Schema，之后每个文件分析完成即写一个记录批次
+ * （批次前附带该批次新出现的字典值），结束时写流结束标记
+ * 输出可以直接由 pyarrow.ipc.open_stream / polars.read_ipc_stream 等零拷贝读取
+ */
+export class ArrowStreamWriter {
+  private fd: number;
+  private ownsFd: boolean;
+  private dictionaries = COLUMNS.filter(column => column.kind === 'dictionary').map(() => new Map<string, number>());
+  private emitted = COLUMNS.filter(column => column.kind === 'dictionary').map(() => 0);
+  private started = false;
+  rows = 0;
+  batches = 0;
+
+  /**
+   * output 为 '-' 时写到标准输出
+   */
+  constructor(output: string) {
+    this.ownsFd = output !== '-';
+    this.fd = this.ownsFd ? fs.openSync(output, 'w') : 1;
+    this.writeMessage(HEADER_SCHEMA, schemaTable(), Buffer.alloc(0));
+  }
+
+  /**
+   * 写入一个文件的全部发现（一个记录批次）；没有发现时不写
+   */
+  addFile(issues: Array<Issue & { severity?: number; fingerprint?: string }>): void {
+    if (issues.length === 0) return;
+
+    const values = COLUMNS.map((column): Array<string | number> => issues.map((issue): string | number => {
+      switch (column.name) {
+        case 'file': return issue.file;
+        case 'category': return issue.category;
+        case 'message_template': return messageTemplate(issue.message);
+        case 'message': return issue.message;
+        case 'line': return issue.line;
+        case 'column': return issue.column || 0;
+        case 'severity': return typeof issue.severity === 'number' ? issue.severity : 1;
+        default: return issue.fingerprint || issueFingerprint(issue.file, issue.category, issue.message, issue.codeLine);
+      }
+    }));
+
+    // 字典列换成索引，并收集本批次新出现的字典值
+    const columns = COLUMNS.map((column, i): Array<string | number> => {
+      if (column.kind !== 'dictionary') return values[i];
+      const dictionary = this.dictionaries[column.dictionaryId!];
+      return values[i].map(value => {
+        let index = dictionary.get(value as string);
+        if (index === undefined) {
+          index = dictionary.size;
+          dictionary.set(value as string, index);
+        }
+        return index;
+      });
+    });
+    this.writeDictionaries();
+
+    const body = new BodyBuilder();
+    const nodes: Array<[number, number]> = [];
+    COLUMNS.forEach((column, i) => {
+      nodes.push([issues.length, 0]);
+      body.addColumn(column.kind === 'dictionary' ? 'int32' : column.kind, columns[i]);
+    });
+    this.writeMessage(HEADER_RECORD_BATCH, recordBatchTable(issues.length, nodes, body.buffers), body.finish());
+    this.rows += issues.length;
+    this.batches++;
+  }
+
+  /**
+   * 写入流结束标记并关闭文件
+   */
+  finish(): void {
+    const eos = Buffer.alloc(8);
+    eos.writeUInt32LE(CONTINUATION, 0);
+    eos.writeInt32LE(0, 4);
+    fs.writeSync(this.fd, eos);
+    if (this.ownsFd) fs.closeSync(this.fd);
+  }
+
+  /**
+   * 每个字典第一次写完整字典批次，之后只在有新值时写增量（isDelta）批次
+   */
+  private writeDictionaries(): void {
+    this.dictionaries.forEach((dictionary, id) => {
+      const from = this.emitted[id];
+      if (this.started && dictionary.size === from) return;
+      const added = Array.from(dictionary.keys()).slice(from);
+      const body = new BodyBuilder();
+      body.addColumn('utf8', added);
+      const batch = recordBatchTable(added.length, [[added.length, 0]], body.buffers);
+      const dictionaryBatch: FbTable = [
+        { type: 'i64', value: id },
+        { type: 'table', value: batch },
+        { type: 'bool', value: from > 0 ? 1 : 0 }
+      ];
+      this.writeMessage(HEADER_DICTIONARY_BATCH, dictionaryBatch, body.finish());
+      this.emitted[id] = dictionary.size;
+    });
+    this.started = true;
+  }
+
+  /**
+   * 封装消息：0xFFFFFFFF、元数据长度、flatbuffer 元数据（补齐到 8 字节）、消息体
+   */
+  private writeMessage(headerType: number, header: FbTable, body: Buffer): void {
+    const message: FbTable = [
+      { type: 'i16', value: METADATA_V5 },
+      { type: 'u8', value: headerType },
+      { type: 'table', value: header },
+      { type: 'i64', value: body.length }
+    ];
+    const metadata = new FlatBufferBuilder().finish(message);
+    const padded = Math.ceil((metadata.length + 8) / 8) * 8 - 8;
+    const prefix = Buffer.alloc(8 + padded);
+    prefix.writeUInt32LE(CONTINUATION, 0);
+    prefix.writeInt32LE(padded, 4);
+    metadata.copy(prefix, 8);
+    fs.writeSync(this.fd, prefix);
+    if (body.length > 0) fs.writeSync(this.fd, body);
+  }
+}
+
+function schemaTable(): FbTable {
+  const fields = COLUMNS.map((column): FbTable => {
+    const valueType = column.kind === 'int32' ? intType(32) : column.kind === 'int8' ? intType(8) : [];
+    const field: FbTable = [
+      { type: 'string', value: column.name },
+      { type: 'bool', value: 0 },                                    // nullable
+      { type: 'u8', value: column.kind === 'int32' || column.kind === 'int8' ? TYPE_INT : TYPE_UTF8 },
+      { type: 'table', value: valueType },
+      column.kind === 'dictionary'
+        ? { type: 'table', value: [{ type: 'i64', value: column.dictionaryId! }, { type: 'table', value: intType(32) }] }
+        : null,
+      { type: 'tables', value: [] }                                  // children
+    ];
+    return field;
+  });
+  return [
+    { type: 'i16', value: 0 },                                       // 小端
+    { type: 'tables', value: fields }
+  ];
+}
+
+function intType(bitWidth: number): FbTable {
+  return [{ type: 'i32', value: bitWidth }, { type: 'bool', value: 1 }];
+}
+
+function recordBatchTable(length: number, nodes: Array<[number, number]>, buffers: Array<[number, number]>): FbTable {
+  return [
+    { type: 'i64', value: length },
+    { type: 'structs', value: nodes },      // FieldNode { length, null_count }
+    { type: 'structs', value: buffers }     // Buffer { offset, length }
+  ];
+}
+
+/**
+ * 消息体：各缓冲区依次排列，每个补齐到 8 字节；没有空值，因此有效位图缓冲区长度为 0
+ */
+class BodyBuilder {
+  buffers: Array<[number, number]> = [];
+  private chunks: Buffer[] = [];
+  private length = 0;
+
+  addColumn(kind: 'utf8' | 'int32' | 'int8', values: Array<string | number>): void {
+    this.add(Buffer.alloc(0));
+    if (kind === 'utf8') {
+      const data = values.map(value => Buffer.from(String(value), 'utf8'));
+      const offsets = Buffer.alloc(4 * (values.length + 1));
+      let offset = 0;
+      data.forEach((bytes, i) => {
+        offsets.writeInt32LE(offset, 4 * i);
+        offset += bytes.length;
+      });
+      offsets.writeInt32LE(offset, 4 * values.length);
+      this.add(offsets);
+      this.add(Buffer.concat(data));
+    } else if (kind === 'int32') {
+      const data = Buffer.alloc(4 * values.length);
+      values.forEach((value, i) => data.writeInt32LE(value as number, 4 * i));
+      this.add(data);
+    } else {
+      const data = Buffer.alloc(values.length);
+      values.forEach((value, i) => data.writeInt8(value as number, i));
+      this.add(data);
+    }
+  }
+
+  finish(): Buffer {
+    return Buffer.concat(this.chunks, this.length);
+  }
+
+  private add(data: Buffer): void {
+    this.buffers.push([this.length, data.length]);
+    const padded = Math.ceil(data.length / 8) * 8;
+    this.chunks.push(data);
+    if (padded > data.length) this.chunks.push(Buffer.alloc(padded - data.length));
+    this.length += padded;
+  }
+}
+
+/**
+ * flatbuffer 表：下标即字段 ID，null 表示字段缺省
+ */
+type FbTable = Array<FbField | null>;
+
+type FbField =
+  | { type: 'bool' | 'u8' | 'i16' | 'i32' | 'i64'; value: number }
+  | { type: 'string'; value: string }
+  | { type: 'table'; value: FbTable }
+  | { type: 'tables'; value: FbTable[] }
+  | { type: 'structs'; value: Array<[number, number]> };   // 两个 int64 组成的结构体向量
+
+const INLINE_SIZE: { [type: string]: number } = { bool: 1, u8: 1, i16: 2, i32: 4, i64: 8 };
+
+/**
+ * 自前向后排布的 flatbuffer 编码：每个表先写 vtable 再写表本身，子对象写在引用它的表之后，
+ * 因此所有 uoffset 都指向更高的地址
+ */
+class FlatBufferBuilder {
+  private buffer = Buffer.alloc(256);
+  private pos = 0;
+
+  finish(root: FbTable): Buffer {
+    this.reserve(4);
+    const rootPos = this.writeTable(root);
+    this.buffer.writeUInt32LE(rootPos, 0);
+    return this.buffer.subarray(0, this.pos);
+  }
+
+  private writeTable(table: FbTable): number {
+    // 表内布局：开头是指向 vtable 的 soffset，字段按大小从大到小排列以满足对齐
+    const layout = table
+      .map((field, id) => ({ field, id, size: field ? INLINE_SIZE[field.type] || 4 : 0 }))
+      .filter(entry => entry.field !== null)
+      .sort((a, b) => b.size - a.size);
+    let cursor = 4;
+    const offsets = new Map<number, number>();
+    for (const entry of layout) {
+      cursor = alignUp(cursor, entry.size);
+      offsets.set(entry.id, cursor);
+      cursor += entry.size;
+    }
+    const tableAlign = layout.some(entry => entry.size === 8) ? 8 : 4;
+
+    this.align(2);
+    const vtablePos = this.reserve(4 + 2 * table.length);
+    this.buffer.writeUInt16LE(4 + 2 * table.length, vtablePos);
+    this.buffer.writeUInt16LE(cursor, vtablePos + 2);
+    table.forEach((_, id) => this.buffer.writeUInt16LE(offsets.get(id) || 0, vtablePos + 4 + 2 * id));
+
+    this.align(tableAlign);
+    const tablePos = this.reserve(cursor);
+    this.buffer.writeInt32LE(tablePos - vtablePos, tablePos);
+
+    const children: Array<{ at: number; field: FbField }> = [];
+    for (const entry of layout) {
+      const field = entry.field!;
+      const at = tablePos + offsets.get(entry.id)!;
+      switch (field.type) {
+        case 'bool':
+        case 'u8': this.buffer.writeUInt8(field.value, at); break;
+        case 'i16': this.buffer.writeInt16LE(field.value, at); break;
+        case 'i32': this.buffer.writeInt32LE(field.value, at); break;
+        case 'i64': this.buffer.writeBigInt64LE(BigInt(field.value), at); break;
+        default: children.push({ at, field });
+      }
+    }
+    for (const child of children) {
+      // 先写子对象（可能扩容 this.buffer），再回填偏移
+      const childPos = this.writeChild(child.field);
+      this.buffer.writeUInt32LE(childPos - child.at, child.at);
+    }
+    return tablePos;
+  }
+
+  private writeChild(field: FbField): number {
+    switch (field.type) {
+      case 'string': {
+        const bytes = Buffer.from(field.value, 'utf8');
+        this.align(4);
+        const at = this.reserve(4 + bytes.length + 1);
+        this.buffer.writeUInt32LE(bytes.length, at);
+        bytes.copy(this.buffer, at + 4);
+        return at;
+      }
+      case 'table':
+        return this.writeTable(field.value);
+      case 'tables': {
+        this.align(4);
+        const at = this.reserve(4 + 4 * field.value.length);
+        this.buffer.writeUInt32LE(field.value.length, at);
+        field.value.forEach((table, i) => {
+          const slot = at + 4 + 4 * i;
+          const tablePos = this.writeTable(table);
+          this.buffer.writeUInt32LE(tablePos - slot, slot);
+        });
+        return at;
+      }
+      case 'structs': {
+        // 元素（两个 int64）需要 8 字节对齐，长度字段放在紧邻其前的 4 字节
+        this.align(4);
+        if ((this.pos + 4) % 8 !== 0) this.reserve(4);
+        const at = this.reserve(4);
+        const data = this.reserve(16 * field.value.length);
+        this.buffer.writeUInt32LE(field.value.length, at);
+        field.value.forEach(([first, second], i) => {
+          this.buffer.writeBigInt64LE(BigInt(first), data + 16 * i);
+          this.buffer.writeBigInt64LE(BigInt(second), data + 16 * i + 8);
+        });
+        return at;
+      }
+      default:
+        throw new Error(`unexpected flatbuffer field ${field.type}`);
+    }
+  }
+
+  private align(n: number): void {
+    const target = alignUp(this.pos, n);
+    if (target > this.pos) this.reserve(target - this.pos);
+  }
+
+  /**
+   * 在末尾预留 n 个置零的字节，返回其起始位置
+   */
+  private reserve(n: number): number {
+    if (this.pos + n > this.buffer.length) {
+      const grown = Buffer.alloc(Math.max(this.buffer.length * 2, this.pos + n));
+      this.buffer.copy(grown, 0, 0, this.pos);
+      this.buffer = grown;
+    }
+    const at = this.pos;
+    this.buffer.fill(0, at, at + n);
+    this.pos += n;
+    return at;
+  }
+}
+
+function alignUp(value: number, n: number): number {
+  return n > 1 ? Math.ceil(value / n) * n : value;
+}
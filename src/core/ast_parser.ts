@@ -36,8 +36,15 @@ export interface IncludeDirective {
   position: { row: number; column: number };
 }
 
+/**
+ * C 解析器：包装一个 tree-sitter 原生解析器
+ * 同一实例可由多个检测器共享（AnalysisEngine 中每个引擎/工作线程一个）；最近一次的解析结果会被记住，
+ * 检测器对同一份源码重复调用 parse 时不再重新解析和转换，分析完一个文件后由持有者调用 reset 释放
+ */
 export class CASTParser {
   private parser: Parser;
+  private lastSource: string | null = null;
+  private lastTree: ASTNode | null = null;
 
   constructor() {
     this.parser = new Parser();
@@ -45,11 +52,24 @@ export class CASTParser {
   }
 
   /**
-   * 解析 C 代码并返回 AST 根节点
+   * 解析 C 代码并返回 AST 根节点（返回的树由调用方共享，不应修改）
    */
   parse(sourceCode: string): ASTNode {
+    if (this.lastTree && this.lastSource === sourceCode) {
+      return this.lastTree;
+    }
     const tree = this.parser.parse(sourceCode);
-    return this.convertNode(tree.rootNode);
+    this.lastTree = this.convertNode(tree.rootNode);
+    this.lastSource = sourceCode;
+    return this.lastTree;
+  }
+
+  /**
+   * 丢弃记住的解析结果，使上一个文件的 AST 可以被回收
+   */
+  reset(): void {
+    this.lastSource = null;
+    this.lastTree = null;
   }
 
   /**
@@ -86,7 +106,6 @@ export class CASTParser {
    */
   extractVariableDeclarations(root: ASTNode, sourceLines: string[]): VariableDeclaration[] {
     const declarations: VariableDeclaration[] = [];
-    const currentScope = this.getCurrentScope(root);
 
     this.traverseNode(root, (node) => {
       if (node.type === 'declaration') {
@@ -96,10 +115,10 @@ export class CASTParser {
           // 跳过结构体字段声明
           return;
         }
-        const vars = this.parseDeclaration(node, currentScope, sourceLines);
+        const vars = this.parseDeclaration(node, this.getCurrentScope(node), sourceLines);
         declarations.push(...vars);
       } else if (node.type === 'parameter_declaration') {
-        const vars = this.parseParameterDeclaration(node, currentScope);
+        const vars = this.parseParameterDeclaration(node, this.getCurrentScope(node));
         declarations.push(...vars);
       }
     });
@@ -428,39 +447,31 @@ export class CASTParser {
   }
 
   /**
-   * 获取当前作用域
+   * 获取当前作用域：所在函数名，文件作用域为 global
+   * 函数原型中的形参也属于该函数；返回指针的函数（int *f(...)）的函数声明器嵌套在 pointer_declarator 中
    */
   private getCurrentScope(node: ASTNode): string {
-    // 检查是否是函数参数
-    const paramDecl = this.findAncestorByType(node, 'parameter_declaration');
+    const paramDecl = node.type === 'parameter_declaration' ? node : this.findAncestorByType(node, 'parameter_declaration');
     if (paramDecl) {
-      // 对于参数，作用域应该是其所属的函数名
-      const funcDef = this.findAncestorByType(paramDecl, 'function_definition');
-      if (funcDef) {
-        const declarator = this.findChildByType(funcDef, 'function_declarator');
-        if (declarator) {
-          const identifier = this.findChildByType(declarator, 'identifier');
-          if (identifier) {
-            return identifier.text;
-          }
-        }
-      }
+      return this.functionName(this.findAncestorByType(paramDecl, 'function_declarator')) || 'parameter';
     }
 
-    // 简化实现，返回 global 或函数名
     const funcDef = this.findAncestorByType(node, 'function_definition');
     if (funcDef) {
-      const declarator = this.findChildByType(funcDef, 'function_declarator');
-      if (declarator) {
-        const identifier = this.findChildByType(declarator, 'identifier');
-        if (identifier) {
-          return identifier.text;
-        }
+      let declarator = funcDef.namedChildren.find(child => child.type.endsWith('declarator'));
+      while (declarator && declarator.type !== 'function_declarator') {
+        declarator = declarator.namedChildren.find(child => child.type.endsWith('declarator'));
       }
+      return this.functionName(declarator || null) || 'local';
     }
     return 'global';
   }
 
+  private functionName(declarator: ASTNode | null): string | null {
+    const identifier = declarator ? this.findChildByType(declarator, 'identifier') : null;
+    return identifier ? identifier.text : null;
+  }
+
   /**
    * 检查节点是否是声明
    */
@@ -10,13 +10,16 @@ import { ASTAdvancedDetector } from '../detectors/ast_advanced_detector';
  * 集成所有检测器，替换原有的启发式逻辑
  */
 export async function analyzeWorkspaceCFilesAST(root: vscode.Uri): Promise<Map<vscode.Uri, vscode.Diagnostic[]>> {
-  const files = await vscode.workspace.findFiles(new vscode.RelativePattern(root.fsPath, '**/*.c'));
+  // cscan.analyzeHeaders 打开时头文件也作为独立文件分析一次
+  const analyzeHeaders = vscode.workspace.getConfiguration('cscan').get<boolean>('analyzeHeaders', false);
+  const files = await vscode.workspace.findFiles(new vscode.RelativePattern(root.fsPath, analyzeHeaders ? '**/*.{c,h}' : '**/*.c'));
   const results = new Map<vscode.Uri, vscode.Diagnostic[]>();
 
   // 创建各种检测器
   const variableDetector = new ASTVariableDetector();
   const libraryDetector = new ASTLibraryDetector();
   const advancedDetector = new ASTAdvancedDetector();
+  const parser = new CASTParser();
 
   for (const file of files) {
     const allDiagnostics: vscode.Diagnostic[] = [];
@@ -30,7 +33,6 @@ export async function analyzeWorkspaceCFilesAST(root: vscode.Uri): Promise<Map<v
       const document = await vscode.workspace.openTextDocument(file);
       const sourceCode = document.getText();
       const sourceLines = sourceCode.split(/\r?\n/);
-      const parser = new CASTParser();
       const ast = parser.parse(sourceCode);
       
       const nullPointerDiags = variableDetector.checkNullPointerDereference(ast, sourceLines);
@@ -0,0 +1,268 @@
+import { ASTNode } from './ast_parser';
+
+export interface FunctionDefinition {
+  key: string;          // 图中的节点：文件 + 函数名
+  name: string;
+  file: string;
+  node: ASTNode;
+  parameters: string[];
+  isStatic: boolean;
+}
+
+export interface CallSite {
+  caller: string;       // 调用方的节点键
+  callee: string;       // 被调函数名
+  node: ASTNode;
+}
+
+/**
+ * 调用图中函数节点的键：文件 + 函数名
+ */
+export function functionKey(file: string, name: string): string {
+  return `${file}\0${name}`;
+}
+
+/**
+ * 调用图
+ * 以 文件 + 函数名 为节点，不同文件中的同名 static 函数（或各测试程序各自的 main）互不覆盖；
+ * 调用按 C 的链接规则解析：同一文件中的定义优先，否则连到其他文件中的非 static 同名函数。
+ * 记录函数定义和调用点，并提供强连通分量（递归识别）和可达性查询
+ */
+export class CallGraph {
+  private functions = new Map<string, FunctionDefinition>();
+  private functionsByName = new Map<string, string[]>();
+  private callSites = new Map<string, CallSite[]>();
+  private sccIndex: Map<string, number> | null = null;
+  private sccs: string[][] | null = null;
+
+  /**
+   * 加入一个翻译单元中的所有函数定义和调用
+   */
+  addTranslationUnit(file: string, root: ASTNode): void {
+    this.sccIndex = null;
+    this.sccs = null;
+
+    this.traverseNode(root, (node) => {
+      if (node.type !== 'function_definition') return;
+      const name = this.functionName(node);
+      if (!name) return;
+
+      const key = functionKey(file, name);
+      const isStatic = node.namedChildren.some(child => child.type === 'storage_class_specifier' && child.text === 'static');
+      if (!this.functions.has(key)) {
+        this.functionsByName.set(name, [...(this.functionsByName.get(name) || []), key]);
+      }
+      this.functions.set(key, { key, name, file, node, parameters: this.parameterNames(node), isStatic });
+      const sites: CallSite[] = [];
+      this.traverseNode(node, (child) => {
+        if (child.type === 'call_expression') {
+          const callee = child.namedChildren[0];
+          if (callee && callee.type === 'identifier') {
+            sites.push({ caller: key, callee: callee.text, node: child });
+          }
+        }
+      });
+      this.callSites.set(key, sites);
+    });
+  }
+
+  getFunction(key: string): FunctionDefinition | undefined {
+    return this.functions.get(key);
+  }
+
+  /**
+   * 在 file 中以 name 调用时实际调用的函数：同一文件中的定义，否则为其他文件中的非 static 定义
+   * 多个文件都有非 static 同名定义（如各自独立的程序）时全部返回
+   */
+  resolve(name: string, file: string): FunctionDefinition[] {
+    const local = this.functions.get(functionKey(file, name));
+    if (local) return [local];
+    return (this.functionsByName.get(name) || [])
+      .map(key => this.functions.get(key)!)
+      .filter(func => !func.isStatic);
+  }
+
+  getFunctions(): FunctionDefinition[] {
+    return Array.from(this.functions.values());
+  }
+
+  /**
+   * 函数内的所有调用点（包括对库函数等未定义函数的调用）
+   */
+  getCallSites(key: string): CallSite[] {
+    return this.callSites.get(key) || [];
+  }
+
+  /**
+   * 调用点实际调用的、在本图内有定义的函数
+   */
+  calleesOf(site: CallSite): FunctionDefinition[] {
+    const caller = this.functions.get(site.caller);
+    return caller ? this.resolve(site.callee, caller.file) : [];
+  }
+
+  /**
+   * 被调函数中在本图内有定义的部分（节点键）
+   */
+  getCallees(key: string): string[] {
+    const callees = new Set<string>();
+    for (const site of this.getCallSites(key)) {
+      for (const callee of this.calleesOf(site)) {
+        callees.add(callee.key);
+      }
+    }
+    return Array.from(callees);
+  }
+
+  /**
+   * 强连通分量，按逆拓扑序返回（被调者所在分量先于调用者）
+   * 使用迭代版 Tarjan 算法，避免大型代码库上的递归栈溢出
+   */
+  stronglyConnectedComponents(): string[][] {
+    if (this.sccs) {
+      return this.sccs;
+    }
+
+    const index = new Map<string, number>();
+    const lowlink = new Map<string, number>();
+    const onStack = new Set<string>();
+    const stack: string[] = [];
+    const result: string[][] = [];
+    let counter = 0;
+
+    for (const start of this.functions.keys()) {
+      if (index.has(start)) continue;
+
+      const work: Array<{ node: string; callees: string[]; next: number }> = [];
+      const enter = (node: string) => {
+        index.set(node, counter);
+        lowlink.set(node, counter);
+        counter++;
+        stack.push(node);
+        onStack.add(node);
+        work.push({ node, callees: this.getCallees(node), next: 0 });
+      };
+      enter(start);
+
+      while (work.length > 0) {
+        const frame = work[work.length - 1];
+        if (frame.next < frame.callees.length) {
+          const callee = frame.callees[frame.next++];
+          if (!index.has(callee)) {
+            enter(callee);
+          } else if (onStack.has(callee)) {
+            lowlink.set(frame.node, Math.min(lowlink.get(frame.node)!, index.get(callee)!));
+          }
+          continue;
+        }
+
+        work.pop();
+        if (work.length > 0) {
+          const parent = work[work.length - 1].node;
+          lowlink.set(parent, Math.min(lowlink.get(parent)!, lowlink.get(frame.node)!));
+        }
+        if (lowlink.get(frame.node) === index.get(frame.node)) {
+          const component: string[] = [];
+          let member: string;
+          do {
+            member = stack.pop()!;
+            onStack.delete(member);
+            component.push(member);
+          } while (member !== frame.node);
+          result.push(component);
+        }
+      }
+    }
+
+    this.sccs = result;
+    this.sccIndex = new Map();
+    result.forEach((component, i) => component.forEach(name => this.sccIndex!.set(name, i)));
+    return result;
+  }
+
+  /**
+   * 函数所在强连通分量的编号
+   */
+  componentOf(key: string): number {
+    this.stronglyConnectedComponents();
+    return this.sccIndex!.get(key) ?? -1;
+  }
+
+  /**
+   * 函数是否参与递归（直接自调用或位于多成员强连通分量中）
+   */
+  isRecursive(key: string): boolean {
+    const components = this.stronglyConnectedComponents();
+    const id = this.componentOf(key);
+    if (id < 0) return false;
+    return components[id].length > 1 || this.getCallees(key).includes(key);
+  }
+
+  /**
+   * 从给定函数出发可达的所有已定义函数（节点键，包括自身）
+   */
+  reachableFrom(key: string): Set<string> {
+    const visited = new Set<string>();
+    const pending = [key];
+    while (pending.length > 0) {
+      const current = pending.pop()!;
+      if (visited.has(current) || !this.functions.has(current)) continue;
+      visited.add(current);
+      pending.push(...this.getCallees(current));
+    }
+    return visited;
+  }
+
+  /**
+   * 取函数定义的函数名
+   */
+  functionName(funcDef: ASTNode): string | null {
+    const declarator = this.findFunctionDeclarator(funcDef);
+    if (!declarator) return null;
+    const identifier = declarator.namedChildren.find(child => child.type === 'identifier');
+    return identifier ? identifier.text : null;
+  }
+
+  /**
+   * 取函数定义的参数名列表
+   */
+  private parameterNames(funcDef: ASTNode): string[] {
+    const names: string[] = [];
+    const declarator = this.findFunctionDeclarator(funcDef);
+    const parameterList = declarator?.namedChildren.find(child => child.type === 'parameter_list');
+    if (!parameterList) return names;
+
+    for (const param of parameterList.namedChildren) {
+      if (param.type !== 'parameter_declaration') continue;
+      let current: ASTNode | undefined = param.namedChildren[param.namedChildren.length - 1];
+      while (current && current.type !== 'identifier') {
+        current = current.namedChildren.find(child => child.type === 'identifier' || child.type.endsWith('_declarator'));
+      }
+      if (current) names.push(current.text);
+    }
+    return names;
+  }
+
+  /**
+   * 查找函数声明器（返回指针的函数会包在 pointer_declarator 内）
+   */
+  private findFunctionDeclarator(funcDef: ASTNode): ASTNode | null {
+    let current: ASTNode | undefined = funcDef.namedChildren.find(child =>
+      child.type === 'function_declarator' || child.type === 'pointer_declarator');
+    while (current && current.type === 'pointer_declarator') {
+      current = current.namedChildren.find(child =>
+        child.type === 'function_declarator' || child.type === 'pointer_declarator');
+    }
+    return current && current.type === 'function_declarator' ? current : null;
+  }
+
+  /**
+   * 遍历 AST 节点
+   */
+  private traverseNode(node: ASTNode, callback: (node: ASTNode) => void): void {
+    callback(node);
+    for (const child of node.namedChildren) {
+      this.traverseNode(child, callback);
+    }
+  }
+}
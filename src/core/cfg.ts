@@ -0,0 +1,250 @@
+import { ASTNode } from './ast_parser';
+
+/**
+ * 控制流边的标签：条件分支、循环进入/退出、switch 分支；顺序执行为空串
+ */
+export type EdgeLabel = '' | 'then' | 'else' | 'loop' | 'exit-loop' | 'case' | 'goto';
+
+export interface CfgEdge {
+  to: number;
+  label: EdgeLabel;
+  caseLabel?: string;     // label 为 case 时的 case 值（default 为 'default'）
+}
+
+export interface CfgNode {
+  id: number;
+  kind: 'entry' | 'exit' | 'statement' | 'branch';
+  ast: ASTNode | null;    // 语句本身；分支节点为条件表达式（for(;;) 等没有条件时为 null）
+  owner: ASTNode | null;  // 分支节点所属的 if/while/for/do/switch 语句
+  line: number;           // 1 起始行号
+  succ: CfgEdge[];
+}
+
+interface BuildContext {
+  breakTo: number | null;
+  continueTo: number | null;
+}
+
+/**
+ * 函数级的语句控制流图
+ * 从函数体末尾向前构造：每条语句在已知后继的情况下生成自己的节点并返回入口节点；
+ * 分支节点以条件表达式为 AST，没有条件时不带 AST（行号取所属语句），因此各节点的源码范围互不重叠，可以按行定位
+ */
+export class ControlFlowGraph {
+  nodes: CfgNode[] = [];
+  entry: number;
+  exit: number;
+  private labels = new Map<string, number>();
+  private gotos: Array<{ node: number; label: string }> = [];
+
+  private constructor(functionNode: ASTNode) {
+    this.exit = this.addNode('exit', null, null, functionNode.endPosition.row + 1);
+    const body = functionNode.namedChildren.find(child => child.type === 'compound_statement');
+    const first = body ? this.build(body, this.exit, { breakTo: null, continueTo: null }) : this.exit;
+    this.entry = this.addNode('entry', null, null, functionNode.startPosition.row + 1);
+    this.nodes[this.entry].succ.push({ to: first, label: '' });
+
+    for (const pending of this.gotos) {
+      const target = this.labels.get(pending.label);
+      this.nodes[pending.node].succ = [{ to: target !== undefined ? target : this.exit, label: 'goto' }];
+    }
+  }
+
+  /**
+   * 为一个 function_definition 构造控制流图
+   */
+  static build(functionNode: ASTNode): ControlFlowGraph {
+    return new ControlFlowGraph(functionNode);
+  }
+
+  /**
+   * 覆盖给定行（1 起始）的所有节点，按源码范围从小到大排列
+   */
+  nodesAtLine(line: number): CfgNode[] {
+    const span = (node: CfgNode) => node.ast ? node.ast.endPosition.row - node.ast.startPosition.row : 0;
+    return this.nodes
+      .filter(node => node.ast && node.ast.startPosition.row + 1 <= line && line <= node.ast.endPosition.row + 1)
+      .sort((a, b) => span(a) - span(b));
+  }
+
+  private addNode(kind: CfgNode['kind'], ast: ASTNode | null, owner: ASTNode | null, line?: number): number {
+    const id = this.nodes.length;
+    this.nodes.push({
+      id,
+      kind,
+      ast,
+      owner,
+      line: line !== undefined ? line : ast ? ast.startPosition.row + 1 : owner ? owner.startPosition.row + 1 : 0,
+      succ: []
+    });
+    return id;
+  }
+
+  /**
+   * 构造语句 statement 的节点，控制流随后到达 next；返回语句的入口节点
+   */
+  private build(statement: ASTNode, next: number, context: BuildContext): number {
+    switch (statement.type) {
+      case 'compound_statement': {
+        let entry = next;
+        const statements = statement.namedChildren.filter(child => child.type !== 'comment');
+        for (let i = statements.length - 1; i >= 0; i--) {
+          entry = this.build(statements[i], entry, context);
+        }
+        return entry;
+      }
+
+      case 'if_statement': {
+        const named = statement.namedChildren.filter(child => child.type !== 'comment');
+        const condition = named[0];
+        const consequence = named[1];
+        let alternative = named[2];
+        if (alternative && alternative.type === 'else_clause') {
+          alternative = alternative.namedChildren.filter(child => child.type !== 'comment')[0];
+        }
+        const branch = this.addNode('branch', condition || null, statement);
+        const thenEntry = consequence ? this.build(consequence, next, context) : next;
+        const elseEntry = alternative ? this.build(alternative, next, context) : next;
+        this.nodes[branch].succ.push({ to: thenEntry, label: 'then' }, { to: elseEntry, label: 'else' });
+        return branch;
+      }
+
+      case 'while_statement': {
+        const named = statement.namedChildren.filter(child => child.type !== 'comment');
+        const branch = this.addNode('branch', named[0] || null, statement);
+        const bodyEntry = named[1] ? this.build(named[1], branch, { breakTo: next, continueTo: branch }) : branch;
+        this.nodes[branch].succ.push({ to: bodyEntry, label: 'loop' }, { to: next, label: 'exit-loop' });
+        return branch;
+      }
+
+      case 'do_statement': {
+        const named = statement.namedChildren.filter(child => child.type !== 'comment');
+        const branch = this.addNode('branch', named[1] || null, statement);
+        const bodyEntry = named[0] ? this.build(named[0], branch, { breakTo: next, continueTo: branch }) : branch;
+        this.nodes[branch].succ.push({ to: bodyEntry, label: 'loop' }, { to: next, label: 'exit-loop' });
+        return bodyEntry;
+      }
+
+      case 'for_statement': {
+        const parts = this.splitFor(statement);
+        const branch = this.addNode('branch', parts.condition || null, statement);
+        const update = parts.update ? this.addNode('statement', parts.update, null) : branch;
+        if (parts.update) this.nodes[update].succ.push({ to: branch, label: '' });
+        const bodyEntry = parts.body ? this.build(parts.body, update, { breakTo: next, continueTo: update }) : update;
+        this.nodes[branch].succ.push({ to: bodyEntry, label: 'loop' });
+        // 没有条件的 for(;;) 只能经 break/return 离开
+        if (parts.condition) this.nodes[branch].succ.push({ to: next, label: 'exit-loop' });
+        if (!parts.init) return branch;
+        const init = this.addNode('statement', parts.init, null);
+        this.nodes[init].succ.push({ to: branch, label: '' });
+        return init;
+      }
+
+      case 'switch_statement': {
+        const named = statement.namedChildren.filter(child => child.type !== 'comment');
+        const branch = this.addNode('branch', named[0] || null, statement);
+        const body = named[1];
+        const cases = body ? body.namedChildren.filter(child => child.type === 'case_statement') : [];
+        // case 之间可以贯穿：从最后一个 case 向前构造
+        let fallthrough = next;
+        const entries: Array<{ entry: number; value: string }> = [];
+        for (let i = cases.length - 1; i >= 0; i--) {
+          const isDefault = cases[i].children.length > 0 && cases[i].children[0].type === 'default';
+          const statements = cases[i].namedChildren.filter(child => child.type !== 'comment').slice(isDefault ? 0 : 1);
+          let entry = fallthrough;
+          for (let j = statements.length - 1; j >= 0; j--) {
+            entry = this.build(statements[j], entry, { breakTo: next, continueTo: context.continueTo });
+          }
+          entries.unshift({ entry, value: isDefault ? 'default' : (cases[i].namedChildren[0] ? cases[i].namedChildren[0].text : '') });
+          fallthrough = entry;
+        }
+        for (const { entry, value } of entries) {
+          this.nodes[branch].succ.push({ to: entry, label: 'case', caseLabel: value });
+        }
+        if (!entries.some(entry => entry.value === 'default')) {
+          this.nodes[branch].succ.push({ to: next, label: 'case', caseLabel: 'default' });
+        }
+        return branch;
+      }
+
+      case 'labeled_statement': {
+        const named = statement.namedChildren.filter(child => child.type !== 'comment');
+        const label = named[0] ? named[0].text : '';
+        const inner = named[1] ? this.build(named[1], next, context) : next;
+        this.labels.set(label, inner);
+        return inner;
+      }
+
+      case 'goto_statement': {
+        const node = this.addNode('statement', statement, null);
+        const label = statement.namedChildren.find(child => child.type === 'statement_identifier');
+        this.gotos.push({ node, label: label ? label.text : '' });
+        return node;
+      }
+
+      case 'return_statement': {
+        const node = this.addNode('statement', statement, null);
+        this.nodes[node].succ.push({ to: this.exit, label: '' });
+        return node;
+      }
+
+      case 'break_statement':
+      case 'continue_statement': {
+        const node = this.addNode('statement', statement, null);
+        const target = statement.type === 'break_statement' ? context.breakTo : context.continueTo;
+        this.nodes[node].succ.push({ to: target !== null ? target : next, label: '' });
+        return node;
+      }
+
+      default: {
+        const node = this.addNode('statement', statement, null);
+        this.nodes[node].succ.push({ to: next, label: '' });
+        return node;
+      }
+    }
+  }
+
+  /**
+   * 拆分 for 语句；转换后的 ASTNode 不保留字段名，通过匿名分隔符（'('、';'、')'）定位各部分
+   */
+  private splitFor(loop: ASTNode): { init?: ASTNode; condition?: ASTNode; update?: ASTNode; body?: ASTNode } {
+    const named = loop.namedChildren.filter(child => child.type !== 'comment');
+    const result: { init?: ASTNode; condition?: ASTNode; update?: ASTNode; body?: ASTNode } = {};
+    let segment = -1;
+    for (const child of loop.children) {
+      if (child.type === '(' && segment === -1) {
+        segment = 0;
+        continue;
+      }
+      if (child.type === ';') {
+        segment++;
+        continue;
+      }
+      if (child.type === ')' && segment >= 0 && segment <= 2) {
+        segment = 3;
+        continue;
+      }
+      if (segment < 0 || child.type === 'comment') {
+        continue;
+      }
+      const counterpart = named.find(n => n.type === child.type &&
+        n.startPosition.row === child.startPosition.row &&
+        n.startPosition.column === child.startPosition.column);
+      if (!counterpart) {
+        continue;
+      }
+      if (segment === 0) {
+        result.init = counterpart;
+        // 声明形式的初始化自带分号
+        if (counterpart.type === 'declaration') segment = 1;
+      } else if (segment === 1) {
+        result.condition = counterpart;
+      } else if (segment === 2) {
+        result.update = counterpart;
+      } else {
+        result.body = counterpart;
+      }
+    }
+    return result;
+  }
+}
@@ -2,8 +2,9 @@ import * as child_process from 'child_process';
 import * as path from 'path';
 import * as fs from 'fs';
 import { Issue } from '../interfaces/types';
+import { FindingDeduplicator } from './fingerprint';
 
-function which(cmd: string): string | null {
+export function which(cmd: string): string | null {
   try {
     const found = child_process.execSync(process.platform === 'win32' ? `cmd /c where ${cmd}` : `which ${cmd}`, { stdio: ['ignore', 'pipe', 'ignore'] }).toString().split(/\r?\n/)[0]?.trim();
     return found && fs.existsSync(found) ? found : null;
@@ -12,16 +13,35 @@ function which(cmd: string): string | null {
   }
 }
 
-export function runClangTidy(targetDir: string): Issue[] {
+/**
+ * 异步执行外部程序（不经 shell），以退出码和完整输出结束；失败不抛出，由调用方按 code 判断
+ */
+export function execFileAsync(file: string, args: string[], options: child_process.ExecFileOptions): Promise<{ code: number; stdout: string; stderr: string }> {
+  return new Promise(resolve => {
+    child_process.execFile(file, args, { maxBuffer: 16 * 1024 * 1024, ...options, encoding: 'utf8' }, (error, stdout, stderr) => {
+      const code = error ? (typeof (error as any).code === 'number' ? (error as any).code : 1) : 0;
+      resolve({ code, stdout: String(stdout), stderr: String(stderr) });
+    });
+  });
+}
+
+/**
+ * headers 为 true 时同时报告目录内头文件中的诊断（-header-filter）；
+ * 同一头文件会经每个包含它的 .c 文件重复报告，按指纹去重后只保留一次
+ */
+export function runClangTidy(targetDir: string, headers: boolean = false): Issue[] {
   const exe = which('clang-tidy.exe') || which('clang-tidy');
   if (!exe) return [];
   const files = fs.readdirSync(targetDir).filter(f => f.endsWith('.c'));
   const issues: Issue[] = [];
+  const deduplicator = new FindingDeduplicator();
+  const headerFilter = headers ? ` -header-filter="^${path.resolve(targetDir).replace(/[\\^$.*+?()[\]{}|]/g, '\\$&')}"` : '';
   for (const f of files) {
     const full = path.join(targetDir, f);
+    const unitIssues: Issue[] = [];
     try {
       // -quiet to reduce noise; without compile_commands, clang-tidy still runs basic checks
-      const out = child_process.execSync(`"${exe}" -quiet "${full}"`, { cwd: targetDir, stdio: ['ignore', 'pipe', 'pipe'] }).toString();
+      const out = child_process.execSync(`"${exe}" -quiet${headerFilter} "${full}"`, { cwd: targetDir, stdio: ['ignore', 'pipe', 'pipe'] }).toString();
       // Parse nothing (no warnings) → continue
       if (!out) continue;
       const lines = out.split(/\r?\n/);
@@ -33,7 +53,7 @@ export function runClangTidy(targetDir: string): Issue[] {
         const lineNo = parseInt(m[2], 10);
         const msg = m[5].trim();
         const check = m[7] || 'clang-tidy';
-        issues.push({ file, line: lineNo, category: `Clang(${check})`, message: msg, codeLine: '' });
+        unitIssues.push({ file, line: lineNo, category: `Clang(${check})`, message: msg, codeLine: '' });
       }
     } catch (e: any) {
       const out = (e.stdout ? e.stdout.toString() : '') + '\n' + (e.stderr ? e.stderr.toString() : '');
@@ -45,9 +65,10 @@ export function runClangTidy(targetDir: string): Issue[] {
         const lineNo = parseInt(m[2], 10);
         const msg = m[5].trim();
         const check = m[7] || 'clang-tidy';
-        issues.push({ file, line: lineNo, category: `Clang(${check})`, message: msg, codeLine: '' });
+        unitIssues.push({ file, line: lineNo, category: `Clang(${check})`, message: msg, codeLine: '' });
       }
     }
+    issues.push(...deduplicator.filter(unitIssues, full));
   }
   return issues;
 }
@@ -0,0 +1,182 @@
+import { CASTParser, ASTNode } from './ast_parser';
+import { LoopAnalyzer } from './loop_analyzer';
+import { CallGraph, functionKey } from './call_graph';
+import { LoopInfo } from '../interfaces/types';
+import { pureFunctions } from '../utils/function_header_map';
+
+export interface InputBoundLoop {
+  line: number;
+  bound: string; // 决定迭代次数的表达式（无条件循环为空串）
+}
+
+export interface FunctionComplexity {
+  name: string;
+  file: string;
+  line: number;
+  maxLoopDepth: number;
+  inputBoundLoops: InputBoundLoop[];
+  recursive: boolean;
+  order: number;          // 估计的多项式阶数：0 => O(1), 1 => O(n), 2 => O(n²) ...
+  orderLabel: string;
+}
+
+/**
+ * 静态循环嵌套复杂度估计
+ * 基于 findLoops + 循环分析器得到每个函数的循环嵌套深度和依赖输入规模的循环，
+ * 再沿调用图把被调函数的阶数叠加到调用点所在的循环深度上，递归通过强连通分量识别
+ */
+export class ComplexityEstimator {
+  private parser: CASTParser;
+  private loopAnalyzer: LoopAnalyzer;
+  private callGraph: CallGraph;
+  private loopsByFunction = new Map<string, LoopInfo[]>();   // 按调用图节点键（文件 + 函数名）
+
+  constructor(parser: CASTParser = new CASTParser()) {
+    this.parser = parser;
+    this.loopAnalyzer = new LoopAnalyzer();
+    this.callGraph = new CallGraph();
+  }
+
+  /**
+   * 加入一个源文件
+   */
+  addFile(filePath: string, sourceCode: string): void {
+    const ast = this.parser.parse(sourceCode);
+    this.callGraph.addTranslationUnit(filePath, ast);
+
+    for (const loop of this.parser.findLoops(ast)) {
+      const funcName = this.enclosingFunctionName(loop);
+      if (!funcName) continue;
+      const key = functionKey(filePath, funcName);
+      if (!this.loopsByFunction.has(key)) {
+        this.loopsByFunction.set(key, []);
+      }
+      this.loopsByFunction.get(key)!.push(this.loopAnalyzer.analyze(loop, pureFunctions));
+    }
+  }
+
+  /**
+   * 计算所有函数的复杂度并按热点程度排序
+   */
+  rankHotspots(): FunctionComplexity[] {
+    const results = new Map<string, FunctionComplexity>();
+
+    // 强连通分量按逆拓扑序给出，被调函数的阶数总是先算好
+    for (const component of this.callGraph.stronglyConnectedComponents()) {
+      for (const key of component) {
+        results.set(key, this.estimateFunction(key, results));
+      }
+    }
+
+    return Array.from(results.values()).sort((a, b) =>
+      b.order - a.order ||
+      Number(b.recursive) - Number(a.recursive) ||
+      b.maxLoopDepth - a.maxLoopDepth ||
+      b.inputBoundLoops.length - a.inputBoundLoops.length ||
+      a.name.localeCompare(b.name) ||
+      a.file.localeCompare(b.file));
+  }
+
+  getCallGraph(): CallGraph {
+    return this.callGraph;
+  }
+
+  /**
+   * 估计单个函数
+   */
+  private estimateFunction(key: string, known: Map<string, FunctionComplexity>): FunctionComplexity {
+    const func = this.callGraph.getFunction(key)!;
+    const loops = this.loopsByFunction.get(key) || [];
+    const inputBound = new Set<ASTNode>();
+    const inputBoundLoops: InputBoundLoop[] = [];
+
+    for (const loop of loops) {
+      if (this.loopAnalyzer.isInputBound(loop, func.parameters)) {
+        inputBound.add(loop.node);
+        inputBoundLoops.push({ line: loop.line, bound: this.boundExpression(loop) });
+      }
+    }
+
+    let maxLoopDepth = 0;
+    let order = 0;
+    for (const loop of loops) {
+      maxLoopDepth = Math.max(maxLoopDepth, this.loopDepth(loop.node, func.node, () => true));
+      order = Math.max(order, this.loopDepth(loop.node, func.node, node => inputBound.has(node)));
+    }
+
+    // 调用点：被调函数的阶数叠加到调用点所在的输入规模循环深度上
+    const ownComponent = this.callGraph.componentOf(key);
+    for (const site of this.callGraph.getCallSites(key)) {
+      for (const definition of this.callGraph.calleesOf(site)) {
+        const callee = known.get(definition.key);
+        if (!callee || this.callGraph.componentOf(definition.key) === ownComponent) continue;
+        const depth = this.loopDepth(site.node, func.node, node => inputBound.has(node));
+        order = Math.max(order, depth + callee.order);
+      }
+    }
+
+    const recursive = this.callGraph.isRecursive(key);
+    return {
+      name: func.name,
+      file: func.file,
+      line: func.node.startPosition.row + 1,
+      maxLoopDepth,
+      inputBoundLoops,
+      recursive,
+      order,
+      orderLabel: this.formatOrder(order) + (recursive ? '，递归' : '')
+    };
+  }
+
+  /**
+   * 循环边界表达式：for 条件中比较运算的另一侧，其余情况返回完整条件
+   */
+  private boundExpression(loop: LoopInfo): string {
+    const condition = loop.conditionNode;
+    if (!condition) return '';
+    let expression = condition;
+    while (expression.type === 'parenthesized_expression' && expression.namedChildren[0]) {
+      expression = expression.namedChildren[0];
+    }
+    if (expression.type === 'binary_expression' && expression.namedChildren.length === 2) {
+      const [left, right] = expression.namedChildren;
+      const leftVar = this.loopAnalyzer.baseIdentifier(left);
+      if (leftVar && loop.writtenVariables.has(leftVar) && /[<>]/.test(expression.text)) {
+        return right.text;
+      }
+    }
+    return expression.text;
+  }
+
+  /**
+   * node 在函数内被多少层满足条件的循环包围（含 node 本身是循环的情况）
+   */
+  private loopDepth(node: ASTNode, funcNode: ASTNode, counts: (loop: ASTNode) => boolean): number {
+    let depth = 0;
+    let current: ASTNode | undefined = node;
+    while (current && current !== funcNode) {
+      if ((current.type === 'for_statement' || current.type === 'while_statement' || current.type === 'do_statement') &&
+          counts(current)) {
+        depth++;
+      }
+      current = current.parent;
+    }
+    return depth;
+  }
+
+  private formatOrder(order: number): string {
+    if (order === 0) return 'O(1)';
+    if (order === 1) return 'O(n)';
+    if (order === 2) return 'O(n²)';
+    if (order === 3) return 'O(n³)';
+    return `O(n^${order})`;
+  }
+
+  private enclosingFunctionName(node: ASTNode): string | null {
+    let current = node.parent;
+    while (current && current.type !== 'function_definition') {
+      current = current.parent;
+    }
+    return current ? this.callGraph.functionName(current) : null;
+  }
+}
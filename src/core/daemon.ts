@@ -0,0 +1,175 @@
+import * as fs from 'fs';
+import * as net from 'net';
+import * as path from 'path';
+import { AnalysisEngine } from './engine';
+import { defaultSocketPath } from './daemon_client';
+import { blobId } from './git_source';
+import { DaemonMetrics, createMetricsServer, parseMetricsAddress } from './metrics';
+import { ResultCache } from './result_cache';
+import { summarizeSymbols } from './symbol_index';
+
+export interface DaemonOptions {
+  metrics?: string;         // 指标端点：端口、主机:端口或 Unix 域套接字路径；不给出时不启动
+  cache?: ResultCache;
+}
+
+/**
+ * 启动常驻分析进程：解析器和检测器只初始化一次，之后通过本地套接字接收分析请求
+ * 每个连接上的请求按到达顺序处理；套接字已被其他存活的 daemon 占用时报错，残留的套接字文件会被清理
+ * 结果按内容哈希缓存，并记录所用本地头文件的 blob ID，内容与头文件都未变时不再分析；给出 options.metrics 时另外在本机提供 Prometheus 指标端点
+ */
+export async function startDaemon(socketPath: string = defaultSocketPath(), options: DaemonOptions = {}): Promise<net.Server> {
+  const engine = new AnalysisEngine();
+  const cache = options.cache || new ResultCache();
+  const metrics = new DaemonMetrics();
+  // 预热：加载语法并走一遍所有检测器
+  await engine.analyzeSource('warmup.c', 'int main(void) { return 0; }\n');
+
+  const server = net.createServer((socket) => {
+    let buffer = '';
+    let queue: Promise<void> = Promise.resolve();
+    socket.setEncoding('utf8');
+    socket.on('error', () => socket.destroy());
+    socket.on('data', (chunk: string) => {
+      buffer += chunk;
+      let newline: number;
+      while ((newline = buffer.indexOf('\n')) >= 0) {
+        const line = buffer.slice(0, newline);
+        buffer = buffer.slice(newline + 1);
+        if (!line) continue;
+        metrics.queueDepth++;
+        queue = queue.then(() => handleRequest(engine, cache, metrics, socket, line));
+      }
+    });
+  });
+
+  // 先校验指标地址，地址不合法时不留下已监听的套接字
+  const address = options.metrics ? parseMetricsAddress(options.metrics) : null;
+  await listen(server, socketPath);
+
+  let metricsServer: net.Server | null = null;
+  let metricsPath: string | null = null;
+  if (address) {
+    metricsServer = createMetricsServer(() => metrics.render(engine.detectorSeconds));
+    if ('path' in address) {
+      metricsPath = address.path;
+      await listen(metricsServer, address.path);
+    } else {
+      await listenTcp(metricsServer, address.host, address.port);
+    }
+  }
+
+  const shutdown = () => {
+    server.close();
+    if (metricsServer) metricsServer.close();
+    metrics.close();
+    if (process.platform !== 'win32') {
+      for (const file of [socketPath, metricsPath]) {
+        if (!file) continue;
+        try { fs.unlinkSync(file); } catch { /* 已被删除 */ }
+      }
+    }
+    process.exit(0);
+  };
+  process.once('SIGINT', shutdown);
+  process.once('SIGTERM', shutdown);
+  return server;
+}
+
+async function handleRequest(engine: AnalysisEngine, cache: ResultCache, metrics: DaemonMetrics,
+                             socket: net.Socket, line: string): Promise<void> {
+  const started = process.hrtime.bigint();
+  let id: number | undefined;
+  metrics.requests++;
+  try {
+    const request = JSON.parse(line);
+    id = request.id;
+    const hash = blobId(request.source);
+    const { headers, used } = readLocalHeaders(request.file, request.source, request.headers);
+    let result = cache.getMatching(hash, request.file, used);
+    if (result) {
+      metrics.cacheHits++;
+    } else {
+      metrics.cacheMisses++;
+      result = await engine.analyzeSource(request.file, request.source, headers);
+      cache.set(hash, result, summarizeSymbols(request.source), used);
+      metrics.recordAnalysis();
+    }
+    socket.write(JSON.stringify({ id, result }) + '\n');
+  } catch (error: any) {
+    metrics.requestErrors++;
+    socket.write(JSON.stringify({ id, error: String(error && error.message || error) }) + '\n');
+  } finally {
+    metrics.queueDepth--;
+    metrics.requestSeconds.observe(Number(process.hrtime.bigint() - started) / 1e9);
+  }
+}
+
+/**
+ * 读取源码中 #include "..." 引用的本地头文件（相对于源文件所在目录解析，与检测器的查找方式一致）
+ * 返回绝对路径 -> 内容，以及绝对路径 -> blob ID（不存在的为 ''）；分析时使用同一份内容，缓存记录的头文件版本与分析所用的一致
+ * 请求自带头文件内容（例如 --staged 给出的暂存区版本）时只在其中查找，不读磁盘
+ */
+function readLocalHeaders(filePath: string, source: string, provided?: { [file: string]: string }):
+    { headers: { [file: string]: string }; used: { [file: string]: string } } {
+  const headers: { [file: string]: string } = {};
+  const used: { [file: string]: string } = {};
+  const pattern = /^[ \t]*#[ \t]*include[ \t]*"([^"\n]+)"/gm;
+  let match: RegExpExecArray | null;
+  while ((match = pattern.exec(source)) !== null) {
+    const headerPath = path.resolve(path.dirname(filePath), match[1]);
+    if (headerPath in used) continue;
+    if (provided) {
+      if (provided[headerPath] !== undefined) headers[headerPath] = provided[headerPath];
+    } else {
+      try {
+        headers[headerPath] = fs.readFileSync(headerPath, 'utf8');
+      } catch {
+        // 不存在的头文件记为 ''
+      }
+    }
+    used[headerPath] = headerPath in headers ? blobId(headers[headerPath]) : '';
+  }
+  return { headers, used };
+}
+
+function listenTcp(server: net.Server, host: string, port: number): Promise<void> {
+  return new Promise((resolve, reject) => {
+    server.once('error', reject);
+    server.listen(port, host, () => {
+      server.removeListener('error', reject);
+      resolve();
+    });
+  });
+}
+
+function listen(server: net.Server, socketPath: string): Promise<void> {
+  return new Promise((resolve, reject) => {
+    const onError = (error: NodeJS.ErrnoException) => {
+      if (error.code !== 'EADDRINUSE' || process.platform === 'win32') {
+        reject(error);
+        return;
+      }
+      // 区分正在运行的 daemon 与上次异常退出留下的套接字文件
+      const probe = net.createConnection(socketPath);
+      probe.once('connect', () => {
+        probe.destroy();
+        reject(new Error(`已有 cscan daemon 在 ${socketPath} 上运行`));
+      });
+      probe.once('error', () => {
+        try { fs.unlinkSync(socketPath); } catch { /* 已被删除 */ }
+        // 重试失败（例如另一个 daemon 抢先监听）时同样要结束等待，而不是留下未处理的 error 事件
+        server.once('error', reject);
+        server.listen(socketPath, () => {
+          server.removeListener('error', reject);
+          resolve();
+        });
+      });
+    };
+    server.once('error', onError);
+    server.listen(socketPath, () => {
+      server.removeListener('error', onError);
+      resolve();
+    });
+  });
+}
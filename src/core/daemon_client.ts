@@ -0,0 +1,101 @@
+import * as net from 'net';
+import * as os from 'os';
+import * as path from 'path';
+import type { IssueRecord } from './engine';
+
+/**
+ * 常驻分析进程的默认套接字：Unix 上为临时目录下按用户区分的 Unix 域套接字，Windows 上为命名管道
+ */
+export function defaultSocketPath(): string {
+  if (process.platform === 'win32') {
+    return `\\\\.\\pipe\\cscan-${os.userInfo().username}`;
+  }
+  const user = typeof process.getuid === 'function' ? String(process.getuid()) : os.userInfo().username;
+  return path.join(os.tmpdir(), `cscan-${user}.sock`);
+}
+
+interface PendingRequest {
+  resolve: (issues: IssueRecord[]) => void;
+  reject: (error: Error) => void;
+}
+
+/**
+ * 常驻分析进程（cscan daemon）的客户端
+ * 协议为按行分隔的 JSON：请求 {id, file, source, headers?}（headers 为本地头文件的绝对路径 -> 内容，给出时 daemon 不读磁盘上的头文件），响应 {id, result} 或 {id, error}
+ * 本模块不加载解析器，没有常驻进程时调用方再回退到进程内分析
+ */
+export class DaemonClient {
+  private socket: net.Socket;
+  private pending = new Map<number, PendingRequest>();
+  private nextId = 1;
+  private buffer = '';
+
+  private constructor(socket: net.Socket) {
+    this.socket = socket;
+    socket.setEncoding('utf8');
+    socket.on('data', (chunk: string) => this.receive(chunk));
+    socket.on('error', (error) => this.failAll(error));
+    socket.on('close', () => this.failAll(new Error('cscan daemon 连接已断开')));
+  }
+
+  /**
+   * 连接常驻进程；未运行（套接字不存在或拒绝连接）或超时时返回 null
+   */
+  static connect(socketPath: string = defaultSocketPath(), timeoutMs: number = 200): Promise<DaemonClient | null> {
+    return new Promise((resolve) => {
+      const socket = net.createConnection(socketPath);
+      const timer = setTimeout(() => {
+        socket.destroy();
+        resolve(null);
+      }, timeoutMs);
+      socket.once('connect', () => {
+        clearTimeout(timer);
+        socket.removeAllListeners('error');
+        resolve(new DaemonClient(socket));
+      });
+      socket.once('error', () => {
+        clearTimeout(timer);
+        resolve(null);
+      });
+    });
+  }
+
+  analyze(file: string, source: string, headers?: { [file: string]: string }): Promise<IssueRecord[]> {
+    const id = this.nextId++;
+    return new Promise((resolve, reject) => {
+      this.pending.set(id, { resolve, reject });
+      this.socket.write(JSON.stringify({ id, file, source, headers }) + '\n');
+    });
+  }
+
+  close(): void {
+    this.socket.end();
+  }
+
+  private receive(chunk: string): void {
+    this.buffer += chunk;
+    let newline: number;
+    while ((newline = this.buffer.indexOf('\n')) >= 0) {
+      const line = this.buffer.slice(0, newline);
+      this.buffer = this.buffer.slice(newline + 1);
+      if (!line) continue;
+      const message = JSON.parse(line);
+      const request = this.pending.get(message.id);
+      if (!request) continue;
+      this.pending.delete(message.id);
+      if (message.error !== undefined) {
+        request.reject(new Error(message.error));
+      } else {
+        request.resolve(message.result);
+      }
+    }
+  }
+
+  private failAll(error: Error): void {
+    const pending = Array.from(this.pending.values());
+    this.pending.clear();
+    for (const request of pending) {
+      request.reject(error);
+    }
+  }
+}
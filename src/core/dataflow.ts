@@ -0,0 +1,211 @@
+import { ASTNode } from './ast_parser';
+import { CfgNode, ControlFlowGraph } from './cfg';
+
+/**
+ * 定长位向量，每一位对应一个被跟踪的变量
+ */
+export class BitSet {
+  readonly words: Uint32Array;
+
+  constructor(size: number) {
+    this.words = new Uint32Array((size + 31) >>> 5);
+  }
+
+  static full(size: number): BitSet {
+    const set = new BitSet(size);
+    for (let i = 0; i < size; i++) set.add(i);
+    return set;
+  }
+
+  add(bit: number): void {
+    this.words[bit >>> 5] |= 1 << (bit & 31);
+  }
+
+  has(bit: number): boolean {
+    return (this.words[bit >>> 5] & (1 << (bit & 31))) !== 0;
+  }
+
+  copy(): BitSet {
+    const set = new BitSet(this.words.length * 32);
+    set.words.set(this.words);
+    return set;
+  }
+
+  equals(other: BitSet): boolean {
+    for (let i = 0; i < this.words.length; i++) {
+      if (this.words[i] !== other.words[i]) return false;
+    }
+    return true;
+  }
+}
+
+/**
+ * 位向量数据流问题：每个节点的传递函数为 out = gen ∪ (in − kill)（后向问题中 in/out 互换）
+ * meet 为 union 时是"可能"问题（如活跃变量），为 intersection 时是"必然"问题（如确定初始化）
+ */
+export interface BitVectorProblem {
+  direction: 'forward' | 'backward';
+  meet: 'union' | 'intersection';
+  size: number;
+  gen: BitSet[];          // 按节点 id
+  kill: BitSet[];
+  boundary: BitSet;       // 前向问题中入口的 in，后向问题中出口的 out
+}
+
+/**
+ * 在控制流图上用工作表迭代求解位向量问题，返回每个节点的 in 与 out（都按执行方向，而非求解方向）
+ */
+export function solveBitVector(graph: ControlFlowGraph, problem: BitVectorProblem): { in: BitSet[]; out: BitSet[] } {
+  const count = graph.nodes.length;
+  const forward = problem.direction === 'forward';
+  const predecessors: number[][] = graph.nodes.map(() => []);
+  for (const node of graph.nodes) {
+    for (const edge of node.succ) predecessors[edge.to].push(node.id);
+  }
+  // 求解方向上的前驱（汇入值的来源）与后继（值变化后需要重新计算的节点）
+  const sources = forward ? predecessors : graph.nodes.map(node => node.succ.map(edge => edge.to));
+  const targets = forward ? graph.nodes.map(node => node.succ.map(edge => edge.to)) : predecessors;
+  const start = forward ? graph.entry : graph.exit;
+
+  const initial = () => problem.meet === 'intersection' ? BitSet.full(problem.size) : new BitSet(problem.size);
+  const before: BitSet[] = [];   // 求解方向上的输入
+  const after: BitSet[] = [];    // 求解方向上的输出
+  for (let id = 0; id < count; id++) {
+    before.push(initial());
+    after.push(initial());
+  }
+
+  const worklist: number[] = [];
+  const queued = new Set<number>();
+  for (let id = count - 1; id >= 0; id--) {
+    worklist.push(id);
+    queued.add(id);
+  }
+
+  while (worklist.length > 0) {
+    const id = worklist.pop()!;
+    queued.delete(id);
+
+    const input = id === start ? problem.boundary.copy() : meetAll(sources[id].map(s => after[s]), problem, initial);
+    before[id] = input;
+    const output = input.copy();
+    const gen = problem.gen[id].words;
+    const kill = problem.kill[id].words;
+    for (let w = 0; w < output.words.length; w++) {
+      output.words[w] = gen[w] | (output.words[w] & ~kill[w]);
+    }
+    if (output.equals(after[id])) continue;
+    after[id] = output;
+    for (const next of targets[id]) {
+      if (!queued.has(next)) {
+        queued.add(next);
+        worklist.push(next);
+      }
+    }
+  }
+
+  return forward ? { in: before, out: after } : { in: after, out: before };
+}
+
+function meetAll(values: BitSet[], problem: BitVectorProblem, initial: () => BitSet): BitSet {
+  if (values.length === 0) return initial();
+  const result = values[0].copy();
+  for (let i = 1; i < values.length; i++) {
+    for (let w = 0; w < result.words.length; w++) {
+      result.words[w] = problem.meet === 'union'
+        ? result.words[w] | values[i].words[w]
+        : result.words[w] & values[i].words[w];
+    }
+  }
+  return result;
+}
+
+/**
+ * 节点中对变量的读与写
+ * defs 只含整体写入的变量（x = ...、x++、int x = ...），writes 为对应的写入表达式；
+ * x += 1、x++ 同时读写 x；p->f = 1、*p = 1、a[i] = 1 都是对 p / a 的读
+ * 变量以 resolve 给出的键表示，默认为名字；按声明区分同名变量时由调用方把标识符解析到其声明
+ */
+export interface UseDef {
+  uses: Set<string>;
+  defs: Set<string>;
+  writes: Array<{ name: string; key: string; node: ASTNode }>;
+}
+
+export function nodeUseDef(node: CfgNode, resolve: (identifier: ASTNode) => string = identifier => identifier.text): UseDef {
+  const result: UseDef = { uses: new Set(), defs: new Set(), writes: [] };
+  if (!node.ast) return result;
+
+  const visit = (current: ASTNode) => {
+    switch (current.type) {
+      case 'assignment_expression': {
+        const left = current.namedChildren[0];
+        const right = current.namedChildren[current.namedChildren.length - 1];
+        if (left && left.type === 'identifier') {
+          // children 中的匿名运算符节点：= 或 +=、<<= 等复合赋值
+          const operator = current.children.find(child => /^(=|[-+*/%&|^]=|<<=|>>=)$/.test(child.type));
+          const key = resolve(left);
+          if (operator && operator.type !== '=') result.uses.add(key);
+          if (right && right !== left) visit(right);
+          result.defs.add(key);
+          result.writes.push({ name: left.text, key, node: current });
+          return;
+        }
+        break;
+      }
+      case 'update_expression': {
+        const target = current.namedChildren[0];
+        if (target && target.type === 'identifier') {
+          const key = resolve(target);
+          result.uses.add(key);
+          result.defs.add(key);
+          result.writes.push({ name: target.text, key, node: current });
+          return;
+        }
+        break;
+      }
+      case 'init_declarator': {
+        const identifier = declaratorIdentifier(current.namedChildren[0]);
+        const value = current.namedChildren[current.namedChildren.length - 1];
+        if (value && value !== current.namedChildren[0]) visit(value);
+        if (identifier) {
+          const key = resolve(identifier);
+          result.defs.add(key);
+          result.writes.push({ name: identifier.text, key, node: current });
+        }
+        return;
+      }
+      case 'declaration': {
+        // 不带初始值的声明器既不读也不写
+        for (const child of current.namedChildren) {
+          if (child.type === 'init_declarator') visit(child);
+          else if (/declarator$/.test(child.type)) visitArraySizes(child);
+        }
+        return;
+      }
+      case 'identifier':
+        result.uses.add(resolve(current));
+        return;
+    }
+    for (const child of current.namedChildren) visit(child);
+  };
+  // 数组声明中的长度表达式（int a[n];）读取 n
+  const visitArraySizes = (declarator: ASTNode) => {
+    for (const child of declarator.namedChildren) {
+      if (/declarator$/.test(child.type)) visitArraySizes(child);
+      else if (child.type !== 'identifier') visit(child);
+    }
+  };
+
+  visit(node.ast);
+  return result;
+}
+
+function declaratorIdentifier(declarator: ASTNode | undefined): ASTNode | null {
+  let current = declarator;
+  while (current && current.type !== 'identifier') {
+    if (!/declarator$/.test(current.type)) return null;
+    current = current.namedChildren[0];
+  }
+  return current || null;
+}
@@ -0,0 +1,147 @@
+import { Issue } from '../interfaces/types';
+import { StandaloneASTVariableDetector } from '../detectors/standalone_ast_variable_detector';
+import { StandaloneASTLibraryDetector } from '../detectors/standalone_ast_library_detector';
+import { StandaloneASTAdvancedDetector } from '../detectors/standalone_ast_advanced_detector';
+import { StandaloneASTPerformanceDetector } from '../detectors/standalone_ast_performance_detector';
+import { StandaloneASTConcurrencyDetector } from '../detectors/standalone_ast_concurrency_detector';
+import { CASTParser } from './ast_parser';
+import { issueFingerprint } from './fingerprint';
+import type { HeapPhaseProfiler } from './heap_profile';
+import { BuildConfiguration, PresenceMap } from './presence';
+
+export { issueFingerprint };
+
+/**
+ * 分析引擎版本；检测器行为变化时递增，用于使按内容缓存的结果失效
+ */
+export const ENGINE_VERSION = '5';
+
+/**
+ * 紧凑的问题记录：在 Issue 基础上带列号、严重级别和指纹
+ */
+export type IssueRecord = Issue & {
+  column: number;
+  severity: number;     // 0=Error, 1=Warning, 2=Information, 3=Hint
+  fingerprint: string;  // 与行号无关，代码上下移动后保持不变
+};
+
+/**
+ * 单个翻译单元的分析引擎（不依赖VSCode API）
+ * 持有一组检测器实例，可重复用于多个文件；CLI、公共 API 和工作线程共用
+ * 检测器共享引擎的一个解析器：每个引擎（每个工作线程）只有一个原生解析器，每个文件只解析、转换一次，
+ * 分析完成后释放该文件的 AST；检测器本身不保存跨文件的状态
+ * 给出构建配置时按可变性分析：tree-sitter 保留 #if 的所有分支，每个文件只解析、检测一次，
+ * 再按所在行的存在条件为问题标注适用的配置，所有配置下都不存在的行上的问题被丢弃
+ */
+export class AnalysisEngine {
+  private parser = new CASTParser();
+  private varDetector = new StandaloneASTVariableDetector(this.parser);
+  private libDetector = new StandaloneASTLibraryDetector(this.parser);
+  private advDetector = new StandaloneASTAdvancedDetector(this.parser);
+  private perfDetector = new StandaloneASTPerformanceDetector(this.parser);
+  private concDetector = new StandaloneASTConcurrencyDetector(this.parser);
+  private configurations: BuildConfiguration[] | null;
+  // 各检测器累计耗时（秒），供 daemon 的指标端点导出
+  readonly detectorSeconds = new Map<string, number>();
+  private profiler: HeapPhaseProfiler | null = null;
+
+  constructor(configurations?: BuildConfiguration[]) {
+    this.configurations = configurations && configurations.length > 0 ? configurations : null;
+  }
+
+  /**
+   * 启用分阶段堆分析（--heap-profile）：先单独解析一次以便把解析与检测器的分配分开统计
+   */
+  setHeapProfiler(profiler: HeapPhaseProfiler | null): void {
+    this.profiler = profiler;
+  }
+
+  /**
+   * 分析一个源文件的内容
+   * headers 给出本地头文件的内容（绝对路径 -> 内容，例如从 git 对象库读出的某个提交中的版本）；给出时不再从磁盘读取头文件
+   */
+  async analyzeSource(filePath: string, sourceCode: string, headers?: { [file: string]: string }): Promise<IssueRecord[]> {
+    const sourceLines = sourceCode.split(/\r?\n/);
+
+    let allIssues: any[];
+    try {
+      if (this.profiler) {
+        await this.profiler.enter('parse');
+        try {
+          this.parser.parse(sourceCode);
+        } catch {
+          // 解析失败由各检测器自行报告
+        }
+        this.profiler.recordUnit(filePath, sourceLines.length, await this.profiler.leave());
+      }
+      allIssues = [
+        ...await this.timed('variable', () => this.varDetector.analyzeFile(filePath, sourceCode)),
+        ...await this.timed('library', () => this.libDetector.analyzeFile(filePath, sourceCode)),
+        ...await this.timed('header_spelling', () => this.libDetector.checkHeaderSpelling(filePath, sourceCode)),
+        ...await this.timed('advanced', () => this.advDetector.analyzeFile(filePath, sourceCode)),
+        ...await this.timed('performance', () => this.perfDetector.analyzeFile(filePath, sourceCode)),
+        ...await this.timed('concurrency', () => this.concDetector.analyzeFile(filePath, sourceCode, headers))
+      ];
+    } finally {
+      this.parser.reset();
+    }
+
+    const records = allIssues.map((issue): IssueRecord => {
+      const codeLine = (sourceLines[issue.line - 1] || '').trim();
+      return {
+        file: filePath,
+        line: issue.line,
+        column: issue.column || 0,
+        category: issue.category,
+        message: issue.message,
+        severity: typeof issue.severity === 'number' ? issue.severity : 1,
+        codeLine,
+        fingerprint: issueFingerprint(filePath, issue.category, issue.message, codeLine)
+      };
+    });
+    return this.configurations
+      ? this.annotateConfigurations(records, allIssues.map(issue => issue.originLine), sourceCode, this.configurations)
+      : records;
+  }
+
+  private async timed(detector: string, run: () => Promise<any[]>): Promise<any[]> {
+    if (this.profiler) await this.profiler.enter(detector);
+    const started = process.hrtime.bigint();
+    try {
+      return await run();
+    } finally {
+      const seconds = Number(process.hrtime.bigint() - started) / 1e9;
+      this.detectorSeconds.set(detector, (this.detectorSeconds.get(detector) || 0) + seconds);
+      if (this.profiler) await this.profiler.leave();
+    }
+  }
+
+  /**
+   * 按存在条件标注问题适用的配置
+   * 检测器对所有 #if 分支一起分析，问题由另一个分支中的声明或赋值引起时（检测器给出 originLine），
+   * 只在问题行与该行同时存在的配置下成立
+   */
+  private annotateConfigurations(records: IssueRecord[], origins: Array<number | undefined>, sourceCode: string,
+                                 configurations: BuildConfiguration[]): IssueRecord[] {
+    const presence = PresenceMap.build(sourceCode, configurations);
+    const annotated: IssueRecord[] = [];
+    records.forEach((record, i) => {
+      const names = presence.configurationsAt(record.line, origins[i]);
+      if (names.length === 0) return;
+      annotated.push({ ...record, configurations: names, presenceCondition: presence.conditionAt(record.line, origins[i]) });
+    });
+    return annotated;
+  }
+}
+
+let sharedEngine: AnalysisEngine | null = null;
+
+/**
+ * 分析一段 C 源码文本（filePath 只用于报告和查找同目录头文件）
+ */
+export async function analyzeSource(text: string, filePath: string = 'input.c'): Promise<IssueRecord[]> {
+  if (!sharedEngine) {
+    sharedEngine = new AnalysisEngine();
+  }
+  return sharedEngine.analyzeSource(filePath, text);
+}
@@ -0,0 +1,48 @@
+import * as crypto from 'crypto';
+import * as path from 'path';
+
+/**
+ * 问题指纹：文件名、类别、消息和规范化后的代码行的哈希
+ * 与行号无关，代码上下移动后保持不变
+ */
+export function issueFingerprint(file: string, category: string, message: string, codeLine: string): string {
+  return crypto.createHash('sha1')
+    .update(`${path.basename(file)}\0${category}\0${message}\0${codeLine.replace(/\s+/g, ' ').trim()}`)
+    .digest('hex')
+    .slice(0, 16);
+}
+
+/**
+ * 跨翻译单元的发现去重：头文件中的同一发现经多个翻译单元（或同一头文件被多次分析）到达时只保留第一次
+ * 键为文件绝对路径 + 指纹 + 该指纹在本单元结果中的序号，同一单元内内容相同的多条发现各自保留
+ */
+export class FindingDeduplicator {
+  private seen = new Set<string>();
+  duplicates = 0;
+
+  /**
+   * 过滤一个分析单元（一个翻译单元或一个头文件）的结果，返回此前未见过的发现
+   * 给出 unitFile 时，位于该单元自身的发现直接保留且不记录：每个文件只作为单元分析一次，
+   * 只有经它到达的其他文件（头文件）中的发现需要去重，记录的键数与头文件中的发现数成正比，而不是与全部发现数成正比
+   */
+  filter<T extends { file: string; category: string; message: string; codeLine: string; fingerprint?: string }>(unitIssues: T[],
+      unitFile?: string): T[] {
+    const ordinals = new Map<string, number>();
+    const unit = unitFile ? path.resolve(unitFile) : null;
+    return unitIssues.filter(issue => {
+      if (unit && path.resolve(issue.file) === unit) return true;
+      const fingerprint = issue.fingerprint || issueFingerprint(issue.file, issue.category, issue.message, issue.codeLine);
+      const base = `${path.resolve(issue.file)}\0${fingerprint}`;
+      const ordinal = ordinals.get(base) || 0;
+      ordinals.set(base, ordinal + 1);
+
+      const key = `${base}\0${ordinal}`;
+      if (this.seen.has(key)) {
+        this.duplicates++;
+        return false;
+      }
+      this.seen.add(key);
+      return true;
+    });
+  }
+}
@@ -0,0 +1,142 @@
+import * as child_process from 'child_process';
+import * as crypto from 'crypto';
+import * as path from 'path';
+
+export interface RevisionBlob {
+  path: string;   // 仓库内相对路径，'/' 分隔
+  blob: string;   // blob 对象 ID
+}
+
+interface PendingRead {
+  blob: string;
+  resolve: (content: Buffer | null) => void;
+  reject: (error: Error) => void;
+}
+
+/**
+ * 与 git hash-object 相同的内容哈希：sha1("blob <长度>\0" + 内容)
+ * 归档扫描与 daemon 用它作为结果缓存的键；归档扫描的条目与 --rev 扫描按 blob ID 写入的条目共用，daemon 的条目另按所用头文件校验；字符串按 UTF-8 编码
+ */
+export function blobId(content: Buffer | string): string {
+  const bytes = typeof content === 'string' ? Buffer.from(content, 'utf8') : content;
+  return crypto.createHash('sha1').update(`blob ${bytes.length}\0`).update(bytes).digest('hex');
+}
+
+/**
+ * 用 git ls-tree 列出某个提交中指定扩展名的文件 blob（不检出工作区）
+ */
+export function listRevisionBlobs(repoDir: string, rev: string, extensions: string[]): Promise<RevisionBlob[]> {
+  return new Promise((resolve, reject) => {
+    child_process.execFile('git', ['ls-tree', '-r', '-z', '--full-tree', rev], {
+      cwd: repoDir,
+      maxBuffer: 256 * 1024 * 1024,
+      encoding: 'utf8'
+    }, (error, stdout) => {
+      if (error) {
+        reject(new Error(`git ls-tree ${rev} 失败: ${error.message}`));
+        return;
+      }
+      const blobs: RevisionBlob[] = [];
+      for (const entry of String(stdout).split('\0')) {
+        // <mode> SP <type> SP <object> TAB <path>
+        const match = entry.match(/^\d+ blob ([0-9a-f]+)\t(.*)$/s);
+        if (match && extensions.some(ext => match[2].endsWith(ext))) {
+          blobs.push({ path: match[2], blob: match[1] });
+        }
+      }
+      resolve(blobs);
+    });
+  });
+}
+
+/**
+ * 通过一个常驻的 git cat-file --batch 进程读取 blob 内容
+ * 请求按顺序写入 stdin，输出按相同顺序解析（<oid> <type> <size>\n<content>\n 或 <oid> missing\n）
+ */
+export class GitBlobReader {
+  private process: child_process.ChildProcessWithoutNullStreams;
+  private pending: PendingRead[] = [];
+  private buffer: Buffer = Buffer.alloc(0);
+  private closed = false;
+
+  constructor(repoDir: string) {
+    this.process = child_process.spawn('git', ['cat-file', '--batch'], { cwd: repoDir });
+    this.process.stdout.on('data', (chunk: Buffer) => {
+      this.buffer = this.buffer.length === 0 ? chunk : Buffer.concat([this.buffer, chunk]);
+      this.drain();
+    });
+    this.process.on('error', (error) => this.failAll(error));
+    this.process.on('exit', (code) => {
+      if (!this.closed) this.failAll(new Error(`git cat-file 意外退出 (${code})`));
+    });
+  }
+
+  /**
+   * 读取 blob 内容；对象不存在时返回 null
+   */
+  read(blob: string): Promise<Buffer | null> {
+    if (this.closed) {
+      return Promise.reject(new Error('GitBlobReader is closed'));
+    }
+    return new Promise((resolve, reject) => {
+      this.pending.push({ blob, resolve, reject });
+      this.process.stdin.write(`${blob}\n`);
+    });
+  }
+
+  close(): void {
+    this.closed = true;
+    this.process.stdin.end();
+    this.failAll(new Error('GitBlobReader is closed'));
+  }
+
+  /**
+   * 按顺序从输出缓冲区中解析完整的响应
+   */
+  private drain(): void {
+    while (this.pending.length > 0) {
+      const newline = this.buffer.indexOf(0x0a);
+      if (newline < 0) return;
+      const header = this.buffer.toString('utf8', 0, newline);
+
+      if (header.endsWith(' missing')) {
+        this.buffer = this.buffer.subarray(newline + 1);
+        this.pending.shift()!.resolve(null);
+        continue;
+      }
+
+      const size = parseInt(header.split(' ')[2], 10);
+      if (isNaN(size)) {
+        this.failAll(new Error(`无法解析 git cat-file 输出: ${header}`));
+        return;
+      }
+      // 内容之后还有一个换行
+      if (this.buffer.length < newline + 1 + size + 1) return;
+      const content = Buffer.from(this.buffer.subarray(newline + 1, newline + 1 + size));
+      this.buffer = this.buffer.subarray(newline + 1 + size + 1);
+      this.pending.shift()!.resolve(content);
+    }
+  }
+
+  private failAll(error: Error): void {
+    const pending = this.pending;
+    this.pending = [];
+    for (const read of pending) {
+      read.reject(error);
+    }
+  }
+}
+
+/**
+ * 源码中 #include "..." 引用的头文件在仓库中的相对路径（相对于源文件所在目录解析，超出仓库根目录的忽略）
+ */
+export function localIncludePaths(filePath: string, source: string): string[] {
+  const paths = new Set<string>();
+  const pattern = /^[ \t]*#[ \t]*include[ \t]*"([^"\n]+)"/gm;
+  let match: RegExpExecArray | null;
+  while ((match = pattern.exec(source)) !== null) {
+    const resolved = path.posix.normalize(path.posix.join(path.posix.dirname(filePath), match[1]));
+    if (!resolved.startsWith('../') && !path.posix.isAbsolute(resolved)) paths.add(resolved);
+  }
+  return Array.from(paths);
+}
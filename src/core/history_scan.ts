@@ -0,0 +1,206 @@
+import * as child_process from 'child_process';
+import * as os from 'os';
+import * as path from 'path';
+import { IssueRecord } from './engine';
+import { RevisionBlob, listRevisionBlobs } from './git_source';
+import { ResultCache } from './result_cache';
+import { BlobAnalyzer } from './revision_scan';
+
+export interface HistoryCommit {
+  id: string;
+  parent: string | null;    // 第一个父提交；根提交为 null
+  subject: string;
+}
+
+export interface HistoryFinding {
+  issue: IssueRecord;                 // 最后一次出现时的问题记录（行号随之后的提交更新）
+  introducedIn: HistoryCommit | null; // 首次出现的提交；范围起点之前已存在时为 null
+  fixedIn: HistoryCommit | null;      // 在范围终点已消失时，使其消失的提交
+}
+
+export interface HistoryScanOptions {
+  extensions?: string[];    // 默认 ['.c']
+  pathPrefix?: string;      // 只扫描该仓库相对目录下的文件
+  jobs?: number;            // 并行工作线程数，默认 CPU 核数
+  cache?: ResultCache;
+}
+
+export interface HistoryScanResult {
+  commits: HistoryCommit[];
+  findings: HistoryFinding[];
+  blobs: number;            // 涉及的不同 blob 数
+  analyzed: number;         // 实际分析的 blob 数（其余命中缓存）
+}
+
+interface FileChange {
+  path: string;
+  blob: string | null;      // 删除时为 null
+}
+
+/**
+ * 扫描提交范围（如 A..B）内的历史，给出每个发现首次出现的提交
+ * 沿第一父提交链从旧到新前进：起点树用 git ls-tree 列出，之后每个提交只取 git diff-tree 的变更文件；
+ * 分析按 blob ID（加引擎版本）缓存，每个不同的 blob 最多分析一次，开销与不同 blob 数成正比而不是提交数 × 文件数
+ * 发现以“文件路径 + 指纹 + 同指纹序号”标识；合并提交按与第一父提交的差异计算，重命名视为删除加新增
+ */
+export async function scanHistory(repoDir: string, range: string, options: HistoryScanOptions = {}): Promise<HistoryScanResult> {
+  const extensions = options.extensions || ['.c'];
+  const prefix = options.pathPrefix ? `${options.pathPrefix.replace(/\/+$/, '')}/` : '';
+  const accept = (file: string) => file.startsWith(prefix) && extensions.some(ext => file.endsWith(ext));
+  const cache = options.cache || new ResultCache();
+
+  const commits = await listCommits(repoDir, range);
+  if (commits.length === 0) {
+    return { commits, findings: [], blobs: 0, analyzed: 0 };
+  }
+
+  // 起点：第一个提交的父提交对应的树
+  const base = commits[0].parent
+    ? (await listRevisionBlobs(repoDir, commits[0].parent, extensions)).filter(blob => accept(blob.path))
+    : [];
+  const changes = await listChanges(repoDir, commits, accept);
+
+  // 收集所有不同的 blob，先并行分析未命中缓存的部分
+  const distinct = new Map<string, RevisionBlob>();
+  for (const blob of base) {
+    if (!distinct.has(blob.blob)) distinct.set(blob.blob, blob);
+  }
+  for (const commitChanges of changes.values()) {
+    for (const change of commitChanges) {
+      if (change.blob && !distinct.has(change.blob)) distinct.set(change.blob, { path: change.path, blob: change.blob });
+    }
+  }
+  const misses = Array.from(distinct.values()).filter(blob => !cache.has(blob.blob));
+  const jobs = Math.max(1, options.jobs || os.cpus().length);
+  const analyzer = new BlobAnalyzer(repoDir, cache, jobs > 1 && misses.length > 1 ? jobs : 1);
+  try {
+    let next = 0;
+    const worker = async () => {
+      while (next < misses.length) {
+        const blob = misses[next++];
+        try {
+          await analyzer.analyze(blob);
+        } catch (error: any) {
+          console.error(`分析 ${blob.path} (${blob.blob.slice(0, 12)}) 时发生错误:`, error.message);
+        }
+      }
+    };
+    await Promise.all(Array.from({ length: Math.min(jobs * 2, Math.max(1, misses.length)) }, worker));
+  } finally {
+    await analyzer.close();
+  }
+
+  // 按提交顺序重放文件状态，比较每个变更文件前后的发现集合
+  const findings = new Map<string, HistoryFinding>();
+  const present = new Map<string, Set<string>>();   // 路径 -> 当前存在的发现键
+
+  const applyFile = (file: string, blob: string | null, commit: HistoryCommit | null) => {
+    const before = present.get(file) || new Set<string>();
+    const after = new Set<string>();
+    if (blob) {
+      const issues = cache.get(blob, path.join(repoDir, file)) || [];
+      const seen = new Map<string, number>();
+      for (const issue of issues) {
+        const ordinal = seen.get(issue.fingerprint) || 0;
+        seen.set(issue.fingerprint, ordinal + 1);
+        const key = `${file}\0${issue.fingerprint}\0${ordinal}`;
+        after.add(key);
+
+        const existing = findings.get(key);
+        if (existing) {
+          existing.issue = issue;
+          existing.fixedIn = null;
+        } else {
+          findings.set(key, { issue, introducedIn: commit, fixedIn: null });
+        }
+      }
+    }
+    for (const key of before) {
+      if (!after.has(key)) findings.get(key)!.fixedIn = commit;
+    }
+    if (after.size > 0) {
+      present.set(file, after);
+    } else {
+      present.delete(file);
+    }
+  };
+
+  for (const blob of base) {
+    applyFile(blob.path, blob.blob, null);
+  }
+  for (const commit of commits) {
+    for (const change of changes.get(commit.id) || []) {
+      applyFile(change.path, change.blob, commit);
+    }
+  }
+
+  return { commits, findings: Array.from(findings.values()), blobs: distinct.size, analyzed: analyzer.analyzed };
+}
+
+/**
+ * 沿第一父提交链列出范围内的提交，从旧到新
+ */
+function listCommits(repoDir: string, range: string): Promise<HistoryCommit[]> {
+  return new Promise((resolve, reject) => {
+    child_process.execFile('git', ['log', '--first-parent', '--reverse', '--format=%H%x09%P%x09%s', range, '--'], {
+      cwd: repoDir,
+      maxBuffer: 256 * 1024 * 1024,
+      encoding: 'utf8'
+    }, (error, stdout) => {
+      if (error) {
+        reject(new Error(`git log ${range} 失败: ${error.message}`));
+        return;
+      }
+      const commits: HistoryCommit[] = [];
+      for (const line of String(stdout).split('\n')) {
+        if (!line) continue;
+        const [id, parents, ...subject] = line.split('\t');
+        commits.push({ id, parent: parents ? parents.split(' ')[0] : null, subject: subject.join('\t') });
+      }
+      resolve(commits);
+    });
+  });
+}
+
+/**
+ * 用一个 git diff-tree --stdin 进程取出所有提交相对第一父提交的文件变更
+ * 输入每行 "<提交> <第一父提交>"（根提交只有提交本身，配合 --root）；-z 输出为
+ * <提交>\0:<旧模式> <新模式> <旧ID> <新ID> <状态>\0<路径>\0...
+ */
+function listChanges(repoDir: string, commits: HistoryCommit[], accept: (file: string) => boolean): Promise<Map<string, FileChange[]>> {
+  return new Promise((resolve, reject) => {
+    const git = child_process.spawn('git', ['diff-tree', '--stdin', '-r', '-z', '--no-renames', '--root'], { cwd: repoDir });
+    const chunks: Buffer[] = [];
+    let stderr = '';
+    git.stdout.on('data', (chunk: Buffer) => chunks.push(chunk));
+    git.stderr.on('data', (chunk: Buffer) => { stderr += chunk.toString(); });
+    git.on('error', reject);
+    git.on('close', (code) => {
+      if (code !== 0) {
+        reject(new Error(`git diff-tree 失败 (${code}): ${stderr.trim()}`));
+        return;
+      }
+      const changes = new Map<string, FileChange[]>();
+      const tokens = Buffer.concat(chunks).toString('utf8').split('\0');
+      let current: FileChange[] = [];
+      for (let i = 0; i < tokens.length; i++) {
+        const token = tokens[i];
+        if (token.startsWith(':')) {
+          const file = tokens[++i];
+          const [, newMode, , newBlob, status] = token.slice(1).split(' ');
+          if (file === undefined || !accept(file)) continue;
+          // 变为子模块（160000）或符号链接（120000）等非普通文件时按删除处理
+          current.push({ path: file, blob: status === 'D' || !newMode.startsWith('100') ? null : newBlob });
+        } else if (/^[0-9a-f]{40,64}$/.test(token)) {
+          current = [];
+          changes.set(token, current);
+        }
+      }
+      resolve(changes);
+    });
+    for (const commit of commits) {
+      git.stdin.write(commit.parent ? `${commit.id} ${commit.parent}\n` : `${commit.id}\n`);
+    }
+    git.stdin.end();
+  });
+}
@@ -0,0 +1,260 @@
+import * as child_process from 'child_process';
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { Issue } from '../interfaces/types';
+import { CASTParser } from './ast_parser';
+import { CallGraph } from './call_graph';
+import { execFileAsync, which } from './clang';
+
+export interface FunctionHotness {
+  name: string;
+  file: string | null;   // 定义所在的源文件（来自调试信息）；无法确定时为 null
+  calls: number;
+  timeNs: number;   // 包含子调用的累计耗时
+}
+
+export interface HotnessOptions {
+  timeoutMs?: number;
+}
+
+/**
+ * 随工具分发的 -finstrument-functions 运行时
+ * 按函数地址统计调用次数和累计耗时（线程局部的调用栈记录进入时间），进程退出时追加写入 CSCAN_PROFILE_OUT
+ * 同时写出 __cyg_profile_func_enter 自身的运行地址作为锚点，用于换算 PIE 加载偏移
+ */
+const PROFILE_RUNTIME = `/* cscan hotness runtime */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#define CSCAN_SLOTS 16384
+#define CSCAN_STACK 4096
+#define CSCAN_NOINST __attribute__((no_instrument_function))
+
+struct cscan_slot { uintptr_t fn; unsigned long long calls; unsigned long long ns; };
+static struct cscan_slot cscan_table[CSCAN_SLOTS];
+static __thread struct { uintptr_t fn; unsigned long long start; } cscan_stack[CSCAN_STACK];
+static __thread int cscan_depth;
+
+void __cyg_profile_func_enter(void *fn, void *site) CSCAN_NOINST;
+void __cyg_profile_func_exit(void *fn, void *site) CSCAN_NOINST;
+
+static CSCAN_NOINST unsigned long long cscan_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+}
+
+static CSCAN_NOINST struct cscan_slot *cscan_lookup(uintptr_t fn) {
+  size_t i = (size_t)((fn >> 4) * 2654435761u) % CSCAN_SLOTS;
+  for (size_t probe = 0; probe < CSCAN_SLOTS; probe++, i = (i + 1) % CSCAN_SLOTS) {
+    uintptr_t current = __atomic_load_n(&cscan_table[i].fn, __ATOMIC_ACQUIRE);
+    if (current == fn) return &cscan_table[i];
+    if (current == 0) {
+      uintptr_t expected = 0;
+      if (__atomic_compare_exchange_n(&cscan_table[i].fn, &expected, fn, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ||
+          expected == fn) {
+        return &cscan_table[i];
+      }
+    }
+  }
+  return NULL;
+}
+
+void __cyg_profile_func_enter(void *fn, void *site) {
+  (void)site;
+  if (cscan_depth < CSCAN_STACK) {
+    cscan_stack[cscan_depth].fn = (uintptr_t)fn;
+    cscan_stack[cscan_depth].start = cscan_now();
+  }
+  cscan_depth++;
+}
+
+void __cyg_profile_func_exit(void *fn, void *site) {
+  (void)site;
+  if (cscan_depth <= 0) return;
+  cscan_depth--;
+  if (cscan_depth >= CSCAN_STACK || cscan_stack[cscan_depth].fn != (uintptr_t)fn) return;
+  struct cscan_slot *slot = cscan_lookup((uintptr_t)fn);
+  if (!slot) return;
+  __atomic_fetch_add(&slot->calls, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&slot->ns, cscan_now() - cscan_stack[cscan_depth].start, __ATOMIC_RELAXED);
+}
+
+static CSCAN_NOINST __attribute__((destructor)) void cscan_dump(void) {
+  const char *out = getenv("CSCAN_PROFILE_OUT");
+  FILE *f = out ? fopen(out, "a") : NULL;
+  if (!f) return;
+  fprintf(f, "anchor %llx\\n", (unsigned long long)(uintptr_t)&__cyg_profile_func_enter);
+  for (size_t i = 0; i < CSCAN_SLOTS; i++) {
+    if (cscan_table[i].fn) {
+      fprintf(f, "fn %llx %llu %llu\\n", (unsigned long long)cscan_table[i].fn, cscan_table[i].calls, cscan_table[i].ns);
+    }
+  }
+  fclose(f);
+}
+`;
+
+/**
+ * 运行时热度测量：以 -finstrument-functions 编译目录中的全部 .c 文件（需恰好构成一个带 main 的程序）并链接内置运行时，
+ * 执行用户提供的命令（命令中的 {exe} 替换为插桩后的可执行文件，也可通过环境变量 CSCAN_EXE 获取），
+ * 汇总每个函数的调用次数与累计耗时。全部在本机完成
+ * 结果按 profileKey(源文件, 函数名) 索引，不同文件中的同名 static 函数分别统计
+ */
+export async function measureHotness(dir: string, command: string, options: HotnessOptions = {}): Promise<Map<string, FunctionHotness>> {
+  const compiler = which('gcc') || which('clang');
+  if (!compiler) {
+    throw new Error('未找到可用的 gcc/clang，无法进行热度测量');
+  }
+
+  const workDir = fs.mkdtempSync(path.join(os.tmpdir(), 'cscan-hotness-'));
+  try {
+    const runtime = path.join(workDir, 'cscan_profile_runtime.c');
+    const exe = path.join(workDir, process.platform === 'win32' ? 'program.exe' : 'program');
+    const profile = path.join(workDir, 'profile.txt');
+    fs.writeFileSync(runtime, PROFILE_RUNTIME, 'utf8');
+
+    // 源文件用绝对路径编译，调试信息（nm -l）中的文件名可以直接与发现的文件比较
+    const sources = fs.readdirSync(dir).filter(f => f.endsWith('.c')).sort().map(f => path.resolve(dir, f));
+    const build = await execFileAsync(compiler,
+      ['-g', '-O1', '-w', '-finstrument-functions', '-I', dir, '-o', exe, ...sources, runtime, '-lm', '-lpthread'],
+      { cwd: dir, timeout: 300000 });
+    if (build.code !== 0) {
+      throw new Error(`插桩构建失败:\n${build.stderr.slice(0, 2000)}`);
+    }
+
+    // 用户命令的输出直接透传到终端
+    await new Promise<void>((resolve, reject) => {
+      const child = child_process.spawn(command.split('{exe}').join(JSON.stringify(exe)), {
+        shell: true,
+        stdio: 'inherit',
+        timeout: options.timeoutMs || 600000,
+        env: { ...process.env, CSCAN_EXE: exe, CSCAN_PROFILE_OUT: profile }
+      });
+      child.on('error', reject);
+      child.on('close', () => resolve());
+    });
+
+    if (!fs.existsSync(profile)) {
+      throw new Error('命令执行后没有生成热度数据，请确认命令运行了 {exe}');
+    }
+    return aggregateProfile(fs.readFileSync(profile, 'utf8'), await functionSymbols(exe));
+  } finally {
+    fs.rmSync(workDir, { recursive: true, force: true });
+  }
+}
+
+/**
+ * 热度表的键：有源文件时为 文件绝对路径 + 函数名，否则只有函数名
+ */
+export function profileKey(file: string | null, name: string): string {
+  return file ? `${path.resolve(file)}\0${name}` : name;
+}
+
+/**
+ * 按函数热度（累计耗时，其次调用次数）排序发现，并把热度写回 issue
+ * 先按发现所在文件与函数查找，调试信息缺失时退回只按函数名查找（同名函数有多个时不匹配）
+ * 不在任何函数内或函数未被执行的发现排在最后，保持原有相对顺序
+ */
+export function rankIssuesByHotness(issues: Issue[], profile: Map<string, FunctionHotness>,
+                                    parser: CASTParser = new CASTParser()): Issue[] {
+  const functionsByFile = new Map<string, Array<{ name: string; start: number; end: number }>>();
+  const enclosing = (issue: Issue): string | null => {
+    if (!functionsByFile.has(issue.file)) {
+      const ranges: Array<{ name: string; start: number; end: number }> = [];
+      try {
+        const graph = new CallGraph();
+        graph.addTranslationUnit(issue.file, parser.parse(fs.readFileSync(issue.file, 'utf8')));
+        for (const func of graph.getFunctions()) {
+          ranges.push({ name: func.name, start: func.node.startPosition.row + 1, end: func.node.endPosition.row + 1 });
+        }
+      } catch {
+        // 无法解析的文件不参与排序
+      }
+      functionsByFile.set(issue.file, ranges);
+    }
+    const func = functionsByFile.get(issue.file)!.find(range => issue.line >= range.start && issue.line <= range.end);
+    return func ? func.name : null;
+  };
+
+  const ranked = issues.map((issue, index): { issue: Issue; index: number } => {
+    const name = enclosing(issue);
+    const hot = name ? profile.get(profileKey(issue.file, name)) || profile.get(name) : undefined;
+    return {
+      issue: hot ? { ...issue, hotness: { function: hot.name, calls: hot.calls, timeNs: hot.timeNs } } : issue,
+      index
+    };
+  });
+
+  ranked.sort((a, b) => {
+    const ha = a.issue.hotness;
+    const hb = b.issue.hotness;
+    if (ha && hb) return hb.timeNs - ha.timeNs || hb.calls - ha.calls || a.index - b.index;
+    if (ha || hb) return ha ? -1 : 1;
+    return a.index - b.index;
+  });
+  return ranked.map(entry => entry.issue);
+}
+
+/**
+ * 汇总运行时输出（可能包含多次进程运行的数据块），把地址按锚点换算为符号
+ * 没有源文件信息的符号只按函数名索引；这样的同名符号不止一个时无法区分，不计入
+ */
+function aggregateProfile(text: string, symbols: FunctionSymbols): Map<string, FunctionHotness> {
+  const result = new Map<string, FunctionHotness>();
+  const unlocated = new Map<string, number>();
+  for (const symbol of symbols.byAddress.values()) {
+    if (!symbol.file) unlocated.set(symbol.name, (unlocated.get(symbol.name) || 0) + 1);
+  }
+  let slide = 0n;
+
+  for (const line of text.split(/\r?\n/)) {
+    const parts = line.trim().split(/\s+/);
+    if (parts[0] === 'anchor' && parts.length === 2) {
+      slide = symbols.anchor === null ? 0n : BigInt(`0x${parts[1]}`) - symbols.anchor;
+    } else if (parts[0] === 'fn' && parts.length === 4) {
+      const symbol = symbols.byAddress.get(BigInt(`0x${parts[1]}`) - slide);
+      if (!symbol || (!symbol.file && unlocated.get(symbol.name)! > 1)) continue;
+      const key = profileKey(symbol.file, symbol.name);
+      const entry = result.get(key) || { name: symbol.name, file: symbol.file, calls: 0, timeNs: 0 };
+      entry.calls += parseInt(parts[2], 10);
+      entry.timeNs += parseInt(parts[3], 10);
+      result.set(key, entry);
+    }
+  }
+  return result;
+}
+
+interface FunctionSymbols {
+  anchor: bigint | null;
+  byAddress: Map<bigint, { name: string; file: string | null }>;
+}
+
+/**
+ * 用 nm 读取可执行文件中的函数符号（macOS 符号带前导下划线）
+ * GNU nm 的 -l 从调试信息给出定义所在的 文件:行，用来区分不同文件中的同名 static 函数
+ */
+async function functionSymbols(exe: string): Promise<FunctionSymbols> {
+  const nm = which('nm');
+  const byAddress = new Map<bigint, { name: string; file: string | null }>();
+  let anchor: bigint | null = null;
+  if (!nm) return { anchor, byAddress };
+
+  const result = await execFileAsync(nm, process.platform === 'darwin' ? [exe] : ['-l', exe],
+    { timeout: 60000, maxBuffer: 64 * 1024 * 1024 });
+  for (const line of result.stdout.split(/\r?\n/)) {
+    const match = line.match(/^([0-9a-fA-F]+)\s+[tT]\s+(\S+)(?:\t(.+):\d+)?$/);
+    if (!match) continue;
+    const address = BigInt(`0x${match[1]}`);
+    const name = process.platform === 'darwin' ? match[2].replace(/^_/, '') : match[2];
+    if (name === '__cyg_profile_func_enter') {
+      anchor = address;
+    } else if (!byAddress.has(address)) {
+      byAddress.set(address, { name, file: match[3] || null });
+    }
+  }
+  return { anchor, byAddress };
+}
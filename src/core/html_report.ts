@@ -0,0 +1,259 @@
+import * as crypto from 'crypto';
+import * as fs from 'fs';
+import * as path from 'path';
+import { Issue } from '../interfaces/types';
+import { LineIndex } from './line_index';
+
+const SNIPPET_CONTEXT = 2;
+const SEVERITY_LABELS = ['Error', 'Warning', 'Information', 'Hint'];
+
+const STYLE = `
+body { font-family: -apple-system, "Segoe UI", "Microsoft YaHei", sans-serif; margin: 24px; color: #222; }
+h1 { font-size: 20px; } h2 { font-size: 16px; margin-top: 28px; }
+a { color: #0b62c4; text-decoration: none; } a:hover { text-decoration: underline; }
+table { border-collapse: collapse; margin: 8px 0; } td, th { border: 1px solid #ddd; padding: 4px 10px; text-align: left; }
+th { background: #f4f4f4; } td.n { text-align: right; font-variant-numeric: tabular-nums; }
+.metrics span { display: inline-block; margin-right: 24px; font-size: 15px; }
+.issue { border: 1px solid #ddd; border-radius: 4px; margin: 12px 0; }
+.issue .head { background: #f7f7f7; padding: 6px 10px; }
+.cat { font-weight: bold; } .sev0 { color: #c0392b; } .sev1 { color: #b9770e; } .sev2, .sev3 { color: #2471a3; }
+pre { margin: 0; padding: 6px 0; font-size: 13px; overflow-x: auto; }
+pre .ln { display: inline-block; width: 56px; color: #999; text-align: right; padding-right: 12px; user-select: none; }
+pre .hit { background: #fff3c4; display: block; }
+`;
+
+interface FileEntry {
+  path: string;       // 相对报告根目录（扫描根）的路径
+  page: string;
+  total: number;
+}
+
+interface DirEntry {
+  total: number;
+  byCategory: Map<string, number>;
+  dirs: Set<string>;
+  files: Set<string>;
+}
+
+/**
+ * 流式 HTML 报告生成器
+ * 扫描过程中逐条写入：每个文件的发现直接追加到该文件的页面，代码片段通过行偏移索引按需读取；
+ * 内存中只保留按类别/目录/文件的计数，结束时生成汇总页和逐级目录页。生成的报告不依赖任何外部资源
+ */
+export class HtmlReportWriter {
+  private outDir: string;
+  private rootDir: string;
+  private files = new Map<string, FileEntry>();
+  private dirs = new Map<string, DirEntry>();
+  private categories = new Map<string, number>();
+  private severities = [0, 0, 0, 0];
+  private total = 0;
+  private current: { file: string; fd: number; index: LineIndex | null } | null = null;
+
+  constructor(outDir: string, rootDir: string) {
+    this.outDir = path.resolve(outDir);
+    this.rootDir = path.resolve(rootDir);
+    fs.mkdirSync(path.join(this.outDir, 'files'), { recursive: true });
+    fs.mkdirSync(path.join(this.outDir, 'dirs'), { recursive: true });
+  }
+
+  /**
+   * 写入一条发现
+   */
+  add(issue: Issue & { severity?: number }): void {
+    const absolute = path.resolve(issue.file);
+    const relative = path.relative(this.rootDir, absolute).split(path.sep).join('/');
+    const severity = typeof issue.severity === 'number' ? Math.max(0, Math.min(3, issue.severity)) : 1;
+
+    this.total++;
+    this.severities[severity]++;
+    this.categories.set(issue.category, (this.categories.get(issue.category) || 0) + 1);
+    this.countDirectories(relative, issue.category);
+
+    let entry = this.files.get(relative);
+    if (!entry) {
+      entry = { path: relative, page: `files/${pageId(relative)}.html`, total: 0 };
+      this.files.set(relative, entry);
+    }
+    entry.total++;
+
+    const fd = this.openFilePage(absolute, entry);
+    fs.writeSync(fd, this.renderIssue(issue, severity));
+  }
+
+  /**
+   * 结束当前文件页面，生成目录页和汇总页
+   */
+  finish(): string {
+    this.closeCurrent();
+    for (const entry of this.files.values()) {
+      fs.appendFileSync(path.join(this.outDir, entry.page), '</body></html>\n');
+    }
+
+    for (const [dir, entry] of this.dirs) {
+      this.writeDirectoryPage(dir, entry);
+    }
+
+    const index = path.join(this.outDir, 'index.html');
+    const fd = fs.openSync(index, 'w');
+    try {
+      fs.writeSync(fd, pageHeader('C 代码扫描报告'));
+      fs.writeSync(fd, `<h1>C 代码扫描报告</h1><p>扫描根目录: ${escapeHtml(this.rootDir)}</p>\n`);
+      fs.writeSync(fd, '<div class="metrics">' +
+        `<span>发现总数 <b>${this.total}</b></span>` +
+        `<span>涉及文件 <b>${this.files.size}</b></span>` +
+        this.severities.map((n, i) => `<span class="sev${i}">${SEVERITY_LABELS[i]} <b>${n}</b></span>`).join('') +
+        '</div>\n');
+
+      fs.writeSync(fd, '<h2>按类别</h2><table><tr><th>类别</th><th>数量</th></tr>\n');
+      for (const [category, count] of sortByCount(this.categories)) {
+        fs.writeSync(fd, `<tr><td>${escapeHtml(category)}</td><td class="n">${count}</td></tr>\n`);
+      }
+      fs.writeSync(fd, '</table>\n');
+
+      const root = this.dirs.get('');
+      if (root) {
+        fs.writeSync(fd, '<h2>按目录</h2>\n');
+        fs.writeSync(fd, this.renderListing('', root, ''));
+      }
+      fs.writeSync(fd, '</body></html>\n');
+    } finally {
+      fs.closeSync(fd);
+    }
+    return index;
+  }
+
+  /**
+   * 按需打开文件页面；发现通常按文件连续到达，只保持一个打开的页面与行索引
+   */
+  private openFilePage(absolute: string, entry: FileEntry): number {
+    if (this.current && this.current.file === entry.path) {
+      return this.current.fd;
+    }
+    this.closeCurrent();
+
+    const pagePath = path.join(this.outDir, entry.page);
+    const isNew = entry.total === 1;
+    const fd = fs.openSync(pagePath, isNew ? 'w' : 'a');
+    if (isNew) {
+      fs.writeSync(fd, pageHeader(entry.path));
+      fs.writeSync(fd, `<p><a href="../index.html">汇总</a> / ${this.breadcrumb(entry.path, '../')}</p><h1>${escapeHtml(entry.path)}</h1>\n`);
+    }
+
+    let index: LineIndex | null = null;
+    try {
+      index = LineIndex.build(absolute);
+    } catch {
+      // 源文件不可读时只输出发现本身
+    }
+    this.current = { file: entry.path, fd, index };
+    return fd;
+  }
+
+  private closeCurrent(): void {
+    if (this.current) {
+      fs.closeSync(this.current.fd);
+      this.current = null;
+    }
+  }
+
+  private renderIssue(issue: Issue, severity: number): string {
+    let snippet = '';
+    const index = this.current && this.current.index;
+    if (index) {
+      const first = Math.max(1, issue.line - SNIPPET_CONTEXT);
+      const lines = index.readLines(first, issue.line + SNIPPET_CONTEXT);
+      snippet = lines.map((text, i) => {
+        const lineNo = first + i;
+        const body = `<span class="ln">${lineNo}</span>${escapeHtml(text)}`;
+        return lineNo === issue.line ? `<span class="hit">${body}</span>` : `${body}\n`;
+      }).join('');
+    } else if (issue.codeLine) {
+      snippet = `<span class="hit"><span class="ln">${issue.line}</span>${escapeHtml(issue.codeLine)}</span>`;
+    }
+
+    return `<div class="issue" id="L${issue.line}"><div class="head"><span class="cat sev${severity}">[${escapeHtml(issue.category)}]</span> ` +
+      `第 ${issue.line} 行 · ${SEVERITY_LABELS[severity]} · ${escapeHtml(issue.message)}` +
+      (issue.configurations ? ` · 配置: ${escapeHtml(issue.configurations.join(', '))}` : '') +
+      `</div><pre>${snippet}</pre></div>\n`;
+  }
+
+  /**
+   * 累加文件所有祖先目录（含根目录 ''）的计数，并记录父子关系
+   */
+  private countDirectories(relative: string, category: string): void {
+    const parts = relative.split('/');
+    for (let depth = 0; depth < parts.length; depth++) {
+      const dir = parts.slice(0, depth).join('/');
+      let entry = this.dirs.get(dir);
+      if (!entry) {
+        entry = { total: 0, byCategory: new Map(), dirs: new Set(), files: new Set() };
+        this.dirs.set(dir, entry);
+      }
+      entry.total++;
+      entry.byCategory.set(category, (entry.byCategory.get(category) || 0) + 1);
+      if (depth + 1 < parts.length) {
+        entry.dirs.add(parts.slice(0, depth + 1).join('/'));
+      } else {
+        entry.files.add(relative);
+      }
+    }
+  }
+
+  private writeDirectoryPage(dir: string, entry: DirEntry): void {
+    const title = dir || '.';
+    const html = pageHeader(title) +
+      `<p><a href="../index.html">汇总</a> / ${this.breadcrumb(dir, '../')}</p><h1>${escapeHtml(title)}</h1>\n` +
+      this.renderListing(dir, entry, '../') + '</body></html>\n';
+    fs.writeFileSync(path.join(this.outDir, `dirs/${pageId(dir)}.html`), html, 'utf8');
+  }
+
+  /**
+   * 目录的子目录和文件列表（带类别计数），链接到下一级页面
+   */
+  private renderListing(dir: string, entry: DirEntry, prefix: string): string {
+    const categories = sortByCount(entry.byCategory).map(([name]) => name);
+    let html = '<table><tr><th>路径</th><th>总数</th>' + categories.map(c => `<th>${escapeHtml(c)}</th>`).join('') + '</tr>\n';
+
+    const row = (label: string, href: string, total: number, byCategory: Map<string, number> | null) =>
+      `<tr><td><a href="${prefix}${href}">${escapeHtml(label)}</a></td><td class="n">${total}</td>` +
+      categories.map(c => `<td class="n">${byCategory ? byCategory.get(c) || '' : ''}</td>`).join('') + '</tr>\n';
+
+    for (const child of Array.from(entry.dirs).sort()) {
+      const childEntry = this.dirs.get(child)!;
+      html += row(`${child.slice(dir ? dir.length + 1 : 0)}/`, `dirs/${pageId(child)}.html`, childEntry.total, childEntry.byCategory);
+    }
+    for (const file of Array.from(entry.files).sort()) {
+      const fileEntry = this.files.get(file)!;
+      html += row(file.slice(dir ? dir.length + 1 : 0), fileEntry.page, fileEntry.total, null);
+    }
+    return html + '</table>\n';
+  }
+
+  private breadcrumb(relative: string, prefix: string): string {
+    const parts = relative ? relative.split('/') : [];
+    const links = [`<a href="${prefix}dirs/${pageId('')}.html">.</a>`];
+    for (let i = 0; i < parts.length - 1; i++) {
+      const dir = parts.slice(0, i + 1).join('/');
+      links.push(`<a href="${prefix}dirs/${pageId(dir)}.html">${escapeHtml(parts[i])}</a>`);
+    }
+    return links.join(' / ');
+  }
+}
+
+function pageHeader(title: string): string {
+  return `<!DOCTYPE html>\n<html lang="zh-CN"><head><meta charset="utf-8"><title>${escapeHtml(title)}</title>` +
+    `<style>${STYLE}</style></head><body>\n`;
+}
+
+function pageId(relative: string): string {
+  return crypto.createHash('sha1').update(relative).digest('hex').slice(0, 12);
+}
+
+function sortByCount(counts: Map<string, number>): Array<[string, number]> {
+  return Array.from(counts.entries()).sort((a, b) => b[1] - a[1] || (a[0] < b[0] ? -1 : 1));
+}
+
+function escapeHtml(text: string): string {
+  return text.replace(/&/g, '&amp;').replace(/</g, '&lt;').replace(/>/g, '&gt;').replace(/"/g, '&quot;');
+}
@@ -0,0 +1,357 @@
+import { CASTParser, ASTNode } from './ast_parser';
+
+export interface InstrumentedSite {
+  id: number;
+  kind: 'uninitialized-read' | 'null-dereference';
+  name: string;
+  line: number;     // 从 1 开始，对应原始源文件
+}
+
+export interface InstrumentResult {
+  code: string;
+  sites: InstrumentedSite[];
+}
+
+export interface RuntimeReport {
+  kind: InstrumentedSite['kind'];
+  name: string;
+  file: string;
+  line: number;
+}
+
+interface Insertion {
+  offset: number;
+  text: string;
+  depth: number;
+  open: boolean;
+}
+
+interface TrackedLocal {
+  name: string;
+  declaration: ASTNode;
+  block: ASTNode;
+  flag: string | null;        // 影子初始化标志；无需跟踪初始化时为 null
+  nullChecked: boolean;       // 是否在解引用前插入 NULL 检查
+}
+
+// 可以安全包装成逗号表达式的标量类型；结构体、联合体及未知 typedef 的非指针变量不插桩
+const SCALAR_TYPES = new Set(['primitive_type', 'sized_type_specifier', 'enum_specifier']);
+
+/**
+ * 源到源插桩器（sanitizer 之外的运行时确认方式）
+ * 只在静态分析无法确定的位置插桩，保持运行开销很小：
+ * - 未初始化且声明后没有直接赋值的局部变量：增加影子初始化标志，写入时置位，读取前检查
+ * - 未初始化或初始化为 NULL/0 的指针：在 findPointerDereferences 找到的解引用之前检查非空
+ * 输出是自包含的标准 C（运行时以 static 函数形式内联在文件开头，并用 #line 保持原始行号），
+ * 可以用任何本地编译器直接编译
+ */
+export class SourceInstrumenter {
+  private parser: CASTParser;
+
+  constructor(parser: CASTParser = new CASTParser()) {
+    this.parser = parser;
+  }
+
+  /**
+   * 对一个翻译单元插桩
+   */
+  instrument(filePath: string, sourceCode: string): InstrumentResult {
+    const ast = this.parser.parse(sourceCode);
+    const lineStarts = this.lineStarts(sourceCode);
+    const offsetOf = (pos: { row: number; column: number }) => lineStarts[pos.row] + pos.column;
+
+    const insertions: Insertion[] = [];
+    const sites: InstrumentedSite[] = [];
+    const addSite = (kind: InstrumentedSite['kind'], name: string, node: ASTNode): number => {
+      const id = sites.length;
+      sites.push({ id, kind, name, line: node.startPosition.row + 1 });
+      return id;
+    };
+    // (prefix, node suffix)：prefix 在 node 之前求值，suffix 在之后
+    const wrap = (node: ASTNode, prefix: string | null, suffix: string = '') => {
+      const depth = this.depth(node);
+      insertions.push({ offset: offsetOf(node.startPosition), text: prefix ? `(${prefix}, ` : '(', depth, open: true });
+      insertions.push({ offset: offsetOf(node.endPosition), text: `${suffix})`, depth, open: false });
+    };
+
+    for (const local of this.uncertainLocals(ast)) {
+      if (local.flag) {
+        insertions.push({
+          offset: offsetOf(local.declaration.endPosition),
+          text: ` unsigned char ${local.flag} = 0;`,
+          depth: 0,
+          open: true
+        });
+      }
+
+      const derefs = local.nullChecked
+        ? this.parser.findPointerDereferences(local.block, local.name)
+            .filter(pos => this.isAfter(pos, local.declaration.endPosition))
+        : [];
+
+      this.forEachUse(local, (ident) => {
+        const parent = ident.parent!;
+        const checks: string[] = [];
+
+        if (local.flag) {
+          if (parent.type === 'assignment_expression' && parent.namedChildren[0] === ident) {
+            // 标志在写入之后才置位，右侧读取（x = x + 1）仍按未初始化检查；不是独立语句时保留赋值表达式的值
+            const compound = this.operatorText(parent) !== '=';
+            const value = parent.parent && parent.parent.type === 'expression_statement' ? '' : `, ${local.name}`;
+            wrap(parent, compound ? `__cscan_check_init(${local.flag}, ${addSite('uninitialized-read', local.name, parent)})` : null,
+                 `, ${local.flag} = 1${value}`);
+            return;
+          }
+          if (parent.type === 'update_expression') {
+            wrap(parent, `__cscan_check_init(${local.flag}, ${addSite('uninitialized-read', local.name, parent)}), ${local.flag} = 1`);
+            return;
+          }
+          if (parent.type === 'pointer_expression' && parent.text.trim().startsWith('&')) {
+            // 取地址后可能由被调函数写入，保守地视为已初始化
+            wrap(parent, `${local.flag} = 1`);
+            return;
+          }
+          checks.push(`__cscan_check_init(${local.flag}, ${addSite('uninitialized-read', local.name, ident)})`);
+        }
+
+        // findPointerDereferences 也会匹配 &p，取地址不是解引用，且逗号表达式不能取地址
+        const addressOf = parent.type === 'pointer_expression' && parent.text.trim().startsWith('&');
+        if (!addressOf && parent.namedChildren[0] === ident &&
+            derefs.some(pos => pos.row === parent.startPosition.row && pos.column === parent.startPosition.column)) {
+          checks.push(`__cscan_check_nonnull(${local.name}, ${addSite('null-dereference', local.name, parent)})`);
+        }
+
+        if (checks.length > 0) {
+          wrap(ident, checks.join(', '));
+        }
+      });
+    }
+
+    return { code: this.render(filePath, sourceCode, insertions, sites), sites };
+  }
+
+  /**
+   * 收集需要插桩的局部变量
+   */
+  private uncertainLocals(ast: ASTNode): TrackedLocal[] {
+    const locals: TrackedLocal[] = [];
+
+    this.traverseNode(ast, (node) => {
+      if (node.type !== 'declaration' || !node.parent || node.parent.type !== 'compound_statement') return;
+      // static / extern 变量有静态存储期或在别处定义
+      if (node.namedChildren.some(child => child.type === 'storage_class_specifier')) return;
+
+      const typeNode = node.namedChildren.find(child => SCALAR_TYPES.has(child.type) ||
+        child.type === 'type_identifier' || child.type === 'struct_specifier' || child.type === 'union_specifier');
+      if (!typeNode) return;
+
+      for (const declarator of node.namedChildren) {
+        if (declarator === typeNode) continue;
+        const initialized = declarator.type === 'init_declarator';
+        const inner = initialized ? declarator.namedChildren[0] : declarator;
+        if (!inner) continue;
+
+        const isPointer = inner.type === 'pointer_declarator';
+        const name = isPointer || inner.type === 'identifier' ? this.declaratorName(inner) : null;
+        if (!name) continue;
+        if (!isPointer && !SCALAR_TYPES.has(typeNode.type)) continue;
+
+        const value = initialized ? declarator.namedChildren[declarator.namedChildren.length - 1] : null;
+        const nullInitialized = isPointer && !!value && /^(NULL|0|\(\s*void\s*\*\s*\)\s*0)$/.test(value.text.trim());
+
+        const local: TrackedLocal = {
+          name,
+          declaration: node,
+          block: node.parent!,
+          flag: null,
+          nullChecked: isPointer && (!initialized || nullInitialized)
+        };
+        if (!initialized && !this.assignedBeforeUse(local)) {
+          local.flag = `__cscan_init_${local.name}_${node.startPosition.row + 1}`;
+        }
+        if (local.flag || local.nullChecked) {
+          locals.push(local);
+        }
+      }
+    });
+
+    return locals;
+  }
+
+  /**
+   * 声明之后第一次出现是同一块中的直接赋值语句（x = ...;，右侧不读 x）时，变量可证明已初始化
+   */
+  private assignedBeforeUse(local: TrackedLocal): boolean {
+    let first: ASTNode | null = null;
+    this.forEachUse(local, (ident) => {
+      if (!first) first = ident;
+    });
+    if (!first) return true;
+
+    const ident = first as ASTNode;
+    const assignment = ident.parent!;
+    if (assignment.type !== 'assignment_expression' || assignment.namedChildren[0] !== ident ||
+        this.operatorText(assignment) !== '=') {
+      return false;
+    }
+    const statement = assignment.parent;
+    const value = assignment.namedChildren[1];
+    return !!statement && statement.type === 'expression_statement' && statement.parent === local.block &&
+           !!value && !this.mentions(value, local.name);
+  }
+
+  /**
+   * 按源码顺序访问声明之后、同一块内对变量的引用；跳过重新声明同名变量的内层作用域和 sizeof
+   */
+  private forEachUse(local: TrackedLocal, callback: (ident: ASTNode) => void): void {
+    const end = local.declaration.endPosition;
+    const visit = (node: ASTNode) => {
+      if (node !== local.block && this.redeclares(node, local.name)) return;
+      if (node.type === 'sizeof_expression') return;
+      if (node.type === 'identifier' && node.text === local.name && this.isAfter(node.startPosition, end)) {
+        const parent = node.parent;
+        const isCallee = parent && parent.type === 'call_expression' && parent.namedChildren[0] === node;
+        if (!isCallee) callback(node);
+        return;
+      }
+      for (const child of node.namedChildren) {
+        visit(child);
+      }
+    };
+    for (const child of local.block.namedChildren) {
+      if (this.isAfter(child.endPosition, end)) visit(child);
+    }
+  }
+
+  /**
+   * 作用域节点（块或 for 语句）是否直接声明了同名变量
+   */
+  private redeclares(node: ASTNode, name: string): boolean {
+    if (node.type !== 'compound_statement' && node.type !== 'for_statement') return false;
+    return node.namedChildren.some(child => child.type === 'declaration' &&
+      child.namedChildren.some(declarator => this.declaratorName(declarator) === name));
+  }
+
+  private declaratorName(node: ASTNode): string | null {
+    let current: ASTNode | undefined = node;
+    while (current) {
+      if (current.type === 'identifier') return current.text;
+      current = current.type.endsWith('declarator')
+        ? current.namedChildren.find(child => child.type === 'identifier' || child.type.endsWith('declarator'))
+        : undefined;
+    }
+    return null;
+  }
+
+  private mentions(node: ASTNode, name: string): boolean {
+    let found = false;
+    this.traverseNode(node, (child) => {
+      if (child.type === 'identifier' && child.text === name) found = true;
+    });
+    return found;
+  }
+
+  /**
+   * 赋值表达式的运算符（位于左右操作数之间的文本）
+   */
+  private operatorText(assignment: ASTNode): string {
+    const [left, right] = assignment.namedChildren;
+    const text = assignment.text;
+    const start = left ? left.text.length : 0;
+    const end = right ? text.lastIndexOf(right.text) : text.length;
+    return text.slice(start, end).trim();
+  }
+
+  /**
+   * 生成插桩后的源码：文件开头是运行时与插桩点表，随后用 #line 恢复原始行号
+   */
+  private render(filePath: string, sourceCode: string, insertions: Insertion[], sites: InstrumentedSite[]): string {
+    // 同一偏移处：闭括号先于开括号；开括号外层在前，闭括号内层在前
+    insertions.sort((a, b) => a.offset - b.offset ||
+      (a.open === b.open ? (a.open ? a.depth - b.depth : b.depth - a.depth) : (a.open ? 1 : -1)));
+
+    let body = '';
+    let last = 0;
+    for (const insertion of insertions) {
+      body += sourceCode.slice(last, insertion.offset) + insertion.text;
+      last = insertion.offset;
+    }
+    body += sourceCode.slice(last);
+
+    if (sites.length === 0) {
+      return sourceCode;
+    }
+
+    const file = JSON.stringify(filePath);
+    const table = sites.map(site => `  { ${site.kind === 'null-dereference' ? 1 : 0}, ${JSON.stringify(site.name)}, ${site.line} }`).join(',\n');
+    const prelude = [
+      '/* cscan instrumentation runtime */',
+      '#include <stdio.h>',
+      '#include <stdlib.h>',
+      'static const struct { int kind; const char *name; int line; } __cscan_sites[] = {',
+      table,
+      '};',
+      `static unsigned char __cscan_reported[${sites.length}];`,
+      'static void __cscan_report(int site) {',
+      '  if (__cscan_reported[site]) return;',
+      '  __cscan_reported[site] = 1;',
+      `  fprintf(stderr, "%s:%d: cscan: %s '%s'\\n", ${file}, __cscan_sites[site].line,`,
+      '          __cscan_sites[site].kind ? "null-dereference" : "uninitialized-read", __cscan_sites[site].name);',
+      '  fflush(stderr);',
+      '}',
+      'static int __cscan_check_init(unsigned char initialized, int site) {',
+      '  if (!initialized) __cscan_report(site);',
+      '  return 0;',
+      '}',
+      'static int __cscan_check_nonnull(const void *pointer, int site) {',
+      '  if (!pointer) { __cscan_report(site); abort(); }',
+      '  return 0;',
+      '}',
+      `#line 1 ${file}`,
+      ''
+    ].join('\n');
+    return prelude + body;
+  }
+
+  private lineStarts(sourceCode: string): number[] {
+    const starts = [0];
+    for (let i = 0; i < sourceCode.length; i++) {
+      if (sourceCode[i] === '\n') starts.push(i + 1);
+    }
+    return starts;
+  }
+
+  private isAfter(pos: { row: number; column: number }, ref: { row: number; column: number }): boolean {
+    return pos.row > ref.row || (pos.row === ref.row && pos.column >= ref.column);
+  }
+
+  private depth(node: ASTNode): number {
+    let depth = 0;
+    for (let current = node.parent; current; current = current.parent) depth++;
+    return depth;
+  }
+
+  /**
+   * 遍历 AST 节点
+   */
+  private traverseNode(node: ASTNode, callback: (node: ASTNode) => void): void {
+    callback(node);
+    for (const child of node.namedChildren) {
+      this.traverseNode(child, callback);
+    }
+  }
+}
+
+/**
+ * 解析插桩程序运行时输出的报告（file:line: cscan: kind 'name'）
+ */
+export function parseInstrumentationLog(text: string): RuntimeReport[] {
+  const reports: RuntimeReport[] = [];
+  for (const line of text.split(/\r?\n/)) {
+    const match = line.match(/^(.*?):(\d+): cscan: (uninitialized-read|null-dereference) '([^']*)'/);
+    if (match) {
+      reports.push({ file: match[1], line: parseInt(match[2], 10), kind: match[3] as RuntimeReport['kind'], name: match[4] });
+    }
+  }
+  return reports;
+}
@@ -0,0 +1,82 @@
+import * as fs from 'fs';
+
+const CHUNK_SIZE = 64 * 1024;
+
+/**
+ * 行偏移索引：只保存每行起始字节偏移（Uint32Array），需要时按偏移定位读取，不在内存中保留文件内容
+ * 用于大规模报告生成时提取代码片段
+ */
+export class LineIndex {
+  private filePath: string;
+  private starts: Uint32Array;
+  private size: number;
+
+  private constructor(filePath: string, starts: Uint32Array, size: number) {
+    this.filePath = filePath;
+    this.starts = starts;
+    this.size = size;
+  }
+
+  /**
+   * 分块扫描文件建立索引
+   */
+  static build(filePath: string): LineIndex {
+    const fd = fs.openSync(filePath, 'r');
+    try {
+      let starts = new Uint32Array(1024);
+      let count = 1; // 第 1 行从 0 开始
+      let position = 0;
+      const chunk = Buffer.alloc(CHUNK_SIZE);
+
+      for (;;) {
+        const read = fs.readSync(fd, chunk, 0, CHUNK_SIZE, position);
+        if (read === 0) break;
+        for (let i = 0; i < read; i++) {
+          if (chunk[i] !== 0x0a) continue;
+          if (count === starts.length) {
+            const grown = new Uint32Array(starts.length * 2);
+            grown.set(starts);
+            starts = grown;
+          }
+          starts[count++] = position + i + 1;
+        }
+        position += read;
+      }
+      // 以换行结尾的文件不计最后的空行
+      if (count > 1 && starts[count - 1] === position) count--;
+      return new LineIndex(filePath, starts.slice(0, count), position);
+    } finally {
+      fs.closeSync(fd);
+    }
+  }
+
+  get lineCount(): number {
+    return this.starts.length;
+  }
+
+  /**
+   * 读取 [from, to] 行（从 1 开始，含两端，自动截断到文件范围），去掉行尾换行
+   */
+  readLines(from: number, to: number): string[] {
+    const first = Math.max(1, from);
+    const last = Math.min(this.starts.length, to);
+    if (first > last) return [];
+
+    const start = this.starts[first - 1];
+    const end = last < this.starts.length ? this.starts[last] : this.size;
+    const buf = Buffer.alloc(end - start);
+    const fd = fs.openSync(this.filePath, 'r');
+    try {
+      fs.readSync(fd, buf, 0, buf.length, start);
+    } finally {
+      fs.closeSync(fd);
+    }
+
+    // 以换行结尾时 split 会多出一个空元素
+    return buf.toString('utf8').split('\n').slice(0, last - first + 1).map(line => line.replace(/\r$/, ''));
+  }
+
+  readLine(line: number): string {
+    return this.readLines(line, line)[0] || '';
+  }
+}
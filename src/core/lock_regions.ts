@@ -0,0 +1,106 @@
+import { ASTNode } from './ast_parser';
+import { CfgNode, ControlFlowGraph } from './cfg';
+
+/**
+ * 获取/释放成对的锁函数：释放函数 -> 与之配对的获取函数
+ */
+const LOCK_PAIRS: { [release: string]: string[] } = {
+  'pthread_mutex_unlock': ['pthread_mutex_lock', 'pthread_mutex_timedlock'],
+  'pthread_spin_unlock': ['pthread_spin_lock'],
+  'pthread_rwlock_unlock': ['pthread_rwlock_rdlock', 'pthread_rwlock_wrlock',
+    'pthread_rwlock_timedrdlock', 'pthread_rwlock_timedwrlock'],
+  'mtx_unlock': ['mtx_lock', 'mtx_timedlock']
+};
+
+const ACQUIRE_FUNCTIONS = new Set(Object.values(LOCK_PAIRS).reduce((all, names) => all.concat(names), [] as string[]));
+
+/**
+ * 持有的锁：锁表达式（去掉取地址符，如 m、s->lock）-> 加锁所在行（1 起始）
+ */
+export type HeldLocks = Map<string, number>;
+
+/**
+ * 函数内的锁区域：在控制流图上做前向数据流分析，求每个节点入口处沿所有路径都持有的锁
+ * （汇合处取交集，只有必然在临界区内的语句才算），并按源码顺序给出每个调用发生时持有的锁
+ * pthread_mutex_trylock 等不一定成功的获取不计入
+ */
+export class LockRegionTracker {
+  /**
+   * 每个节点入口处必然持有的锁；从函数入口不可达的节点为 null
+   */
+  heldAtEntry(graph: ControlFlowGraph): Array<HeldLocks | null> {
+    const held: Array<HeldLocks | null> = graph.nodes.map(() => null);
+    held[graph.entry] = new Map();
+    const worklist = [graph.entry];
+    const queued = new Set(worklist);
+
+    while (worklist.length > 0) {
+      const id = worklist.shift()!;
+      queued.delete(id);
+      const out = this.walkCalls(graph.nodes[id], held[id]!);
+
+      for (const edge of graph.nodes[id].succ) {
+        const before = held[edge.to];
+        const merged = before ? intersect(before, out) : new Map(out);
+        if (before && merged.size === before.size) continue;
+        held[edge.to] = merged;
+        if (!queued.has(edge.to)) {
+          queued.add(edge.to);
+          worklist.push(edge.to);
+        }
+      }
+    }
+    return held;
+  }
+
+  /**
+   * 按源码顺序遍历节点中的调用，visit 收到调用本身以及调用前持有的锁；返回节点出口处持有的锁
+   */
+  walkCalls(node: CfgNode, held: HeldLocks, visit?: (call: ASTNode, callee: string, held: HeldLocks) => void): HeldLocks {
+    const current = new Map(held);
+    if (!node.ast) return current;
+
+    walkPostOrder(node.ast, child => {
+      if (child.type !== 'call_expression') return;
+      const callee = child.namedChildren[0];
+      if (!callee || callee.type !== 'identifier') return;
+
+      if (visit) visit(child, callee.text, current);
+      if (ACQUIRE_FUNCTIONS.has(callee.text)) {
+        const lock = lockName(child);
+        if (lock && !current.has(lock)) current.set(lock, child.startPosition.row + 1);
+      } else if (callee.text in LOCK_PAIRS) {
+        const lock = lockName(child);
+        if (lock) current.delete(lock);
+      }
+    });
+    return current;
+  }
+}
+
+/**
+ * 锁函数的第一个实参，去掉取地址符与空白：&s->lock -> s->lock
+ */
+function lockName(call: ASTNode): string | null {
+  const argumentList = call.namedChildren.find(child => child.type === 'argument_list');
+  const first = argumentList ? argumentList.namedChildren[0] : undefined;
+  return first ? first.text.replace(/\s+/g, '').replace(/^&/, '') : null;
+}
+
+function intersect(a: HeldLocks, b: HeldLocks): HeldLocks {
+  const result: HeldLocks = new Map();
+  for (const [lock, line] of a) {
+    if (b.has(lock)) result.set(lock, line);
+  }
+  return result;
+}
+
+/**
+ * 后序遍历：实参中的调用先于外层调用，与求值顺序一致
+ */
+function walkPostOrder(node: ASTNode, callback: (node: ASTNode) => void): void {
+  for (const child of node.namedChildren) {
+    walkPostOrder(child, callback);
+  }
+  callback(node);
+}
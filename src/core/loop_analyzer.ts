@@ -0,0 +1,329 @@
+import { ASTNode } from './ast_parser';
+import { LoopInfo } from '../interfaces/types';
+
+const LOOP_TYPES = new Set(['for_statement', 'while_statement', 'do_statement']);
+
+/**
+ * 循环分析器
+ * 在 findLoops 找到的循环节点上提取循环各组成部分以及循环内的写集合，
+ * 供性能类检测器复用
+ */
+export class LoopAnalyzer {
+  /**
+   * 分析单个循环节点
+   * globals: 全局变量名集合；循环内调用了未知（非库）函数时，全局变量视为可能被修改
+   */
+  analyze(loop: ASTNode, pureFunctions: Set<string> = new Set(), globals: Set<string> = new Set()): LoopInfo {
+    const parts = this.splitLoop(loop);
+    const writtenVariables = new Set<string>();
+    const calledFunctions: string[] = [];
+    let hasBreak = false;
+    let hasReturn = false;
+    let callsUnknownFunction = false;
+
+    // for 的初始化部分只执行一次，不计入循环内的写集合
+    const iterated = [parts.conditionNode, parts.updateNode, parts.body].filter((n): n is ASTNode => !!n);
+
+    for (const part of iterated) {
+      this.traverseNode(part, (node) => {
+        switch (node.type) {
+          case 'assignment_expression': {
+            const target = this.baseIdentifier(node.namedChildren[0]);
+            if (target) writtenVariables.add(target);
+            break;
+          }
+          case 'update_expression': {
+            const target = this.baseIdentifier(node.namedChildren[0]);
+            if (target) writtenVariables.add(target);
+            break;
+          }
+          case 'pointer_expression': {
+            // &x 取地址后可能被间接修改
+            if (node.text.trim().startsWith('&')) {
+              const target = this.baseIdentifier(node.namedChildren[0]);
+              if (target) writtenVariables.add(target);
+            }
+            break;
+          }
+          case 'init_declarator':
+          case 'declaration': {
+            // 循环体内声明的变量每次迭代都会重新定义
+            const declared = this.declaredName(node);
+            if (declared) writtenVariables.add(declared);
+            break;
+          }
+          case 'call_expression': {
+            const callee = node.namedChildren[0];
+            if (!callee || callee.type !== 'identifier') break;
+            calledFunctions.push(callee.text);
+            if (pureFunctions.has(callee.text)) break;
+            // 传给非纯函数的指针/数组实参可能被写入：p->buf、&ctx、buf + off 都归到根变量
+            const argumentList = this.findChildByType(node, 'argument_list');
+            if (argumentList) {
+              for (const arg of argumentList.namedChildren) {
+                const target = this.baseIdentifier(this.pointerOperand(arg));
+                if (target) writtenVariables.add(target);
+              }
+            }
+            if (!LIBRARY_SIDE_EFFECT_FREE_GLOBALS.has(callee.text)) {
+              callsUnknownFunction = true;
+            }
+            break;
+          }
+          case 'break_statement':
+            if (this.enclosingLoop(node) === loop) hasBreak = true;
+            break;
+          case 'return_statement':
+            hasReturn = true;
+            break;
+        }
+      });
+    }
+
+    if (callsUnknownFunction) {
+      for (const name of globals) writtenVariables.add(name);
+    }
+
+    return {
+      type: loop.type === 'for_statement' ? 'for' : loop.type === 'while_statement' ? 'while' : 'do',
+      init: parts.initNode?.text,
+      condition: parts.conditionNode ? parts.conditionNode.text : '',
+      update: parts.updateNode?.text,
+      line: loop.startPosition.row + 1,
+      hasBreak,
+      hasReturn,
+      writtenVariables,
+      calledFunctions,
+      node: loop,
+      body: parts.body,
+      conditionNode: parts.conditionNode,
+      updateNode: parts.updateNode
+    };
+  }
+
+  /**
+   * 查找节点所在的最内层循环
+   */
+  enclosingLoop(node: ASTNode): ASTNode | null {
+    let current = node.parent;
+    while (current) {
+      if (LOOP_TYPES.has(current.type)) {
+        return current;
+      }
+      current = current.parent;
+    }
+    return null;
+  }
+
+  /**
+   * 判断节点是否属于该循环的迭代部分（条件、更新或循环体），而不是 for 的初始化部分
+   */
+  isInIteratedPart(node: ASTNode, info: LoopInfo): boolean {
+    const parts = [info.conditionNode, info.updateNode, info.body];
+    let current: ASTNode | undefined = node;
+    while (current && current !== info.node) {
+      if (parts.includes(current)) {
+        return true;
+      }
+      current = current.parent;
+    }
+    return false;
+  }
+
+  /**
+   * 判断循环次数是否取决于输入规模
+   * 只有条件中的边界全部是数字字面量、大写宏或 sizeof 时才认为是常数次循环；
+   * 链表遍历（p != NULL）、字符串扫描（s[i] != '\0'）和无条件循环都视为依赖输入
+   */
+  isInputBound(loop: LoopInfo, parameters: string[] = []): boolean {
+    const condition = loop.conditionNode;
+    if (!condition || condition.text === '1' || condition.text === 'true') {
+      return true;
+    }
+
+    let hasConstantBound = false;
+    let hasInputBound = false;
+    this.traverseNode(condition, (node) => {
+      switch (node.type) {
+        case 'number_literal':
+          if (!/^0+[uUlL]*$/.test(node.text)) hasConstantBound = true;
+          break;
+        case 'sizeof_expression':
+          hasConstantBound = true;
+          break;
+        case 'identifier':
+          if (loop.writtenVariables.has(node.text) || this.isInsideSizeof(node, condition)) break;
+          if (node.text === 'NULL') break;
+          if (/^[A-Z][A-Z0-9_]*$/.test(node.text)) {
+            hasConstantBound = true;
+          } else {
+            hasInputBound = true;
+          }
+          break;
+        case 'field_expression':
+        case 'call_expression':
+          if (!this.isInsideSizeof(node, condition)) hasInputBound = true;
+          break;
+      }
+    });
+
+    if (hasInputBound) return true;
+    // 参数直接出现在条件中也是输入规模
+    if (parameters.some(param => new RegExp(`\\b${param}\\b`).test(condition.text))) return true;
+    return !hasConstantBound;
+  }
+
+  /**
+   * 取左值表达式的根标识符：a[i]、p->x、*p、s.f 都归到 a / p / s
+   */
+  baseIdentifier(node: ASTNode | undefined): string | null {
+    let current = node;
+    while (current) {
+      if (current.type === 'identifier') {
+        return current.text;
+      }
+      if (['subscript_expression', 'field_expression', 'pointer_expression',
+           'parenthesized_expression', 'cast_expression'].includes(current.type)) {
+        current = current.type === 'cast_expression'
+          ? current.namedChildren[current.namedChildren.length - 1]
+          : current.namedChildren[0];
+        continue;
+      }
+      return null;
+    }
+    return null;
+  }
+
+  /**
+   * 指针算术（buf + off、end - n）中指针一侧的操作数；其他表达式原样返回
+   */
+  private pointerOperand(node: ASTNode): ASTNode {
+    let current = node;
+    while (current.type === 'binary_expression' && current.namedChildren[0] &&
+           current.children.some(child => child.type === '+' || child.type === '-')) {
+      current = current.namedChildren[0];
+    }
+    return current;
+  }
+
+  /**
+   * 拆分循环的初始化、条件、更新和循环体
+   * 转换后的 ASTNode 不保留字段名，因此通过匿名分隔符（'('、';'、')'）定位各部分
+   */
+  private splitLoop(loop: ASTNode): { initNode?: ASTNode; conditionNode?: ASTNode; updateNode?: ASTNode; body?: ASTNode } {
+    const named = loop.namedChildren.filter(child => child.type !== 'comment');
+
+    if (loop.type === 'while_statement') {
+      return { conditionNode: named[0], body: named[1] };
+    }
+    if (loop.type === 'do_statement') {
+      return { body: named[0], conditionNode: named[1] };
+    }
+
+    // for_statement: for ( init ; cond ; update ) body
+    const result: { initNode?: ASTNode; conditionNode?: ASTNode; updateNode?: ASTNode; body?: ASTNode } = {};
+    let segment = -1;
+    for (const child of loop.children) {
+      if (child.type === '(' && segment === -1) {
+        segment = 0;
+        continue;
+      }
+      if (child.type === ';') {
+        segment++;
+        continue;
+      }
+      if (child.type === ')' && segment >= 0 && segment <= 2) {
+        segment = 3;
+        continue;
+      }
+      if (segment < 0 || child.type === 'comment') {
+        continue;
+      }
+      const counterpart = named.find(n => n.type === child.type &&
+        n.startPosition.row === child.startPosition.row &&
+        n.startPosition.column === child.startPosition.column);
+      if (!counterpart) {
+        continue;
+      }
+      if (segment === 0) {
+        result.initNode = counterpart;
+        // 声明形式的初始化自带分号
+        if (counterpart.type === 'declaration') segment = 1;
+      } else if (segment === 1) {
+        result.conditionNode = counterpart;
+      } else if (segment === 2) {
+        result.updateNode = counterpart;
+      } else {
+        result.body = counterpart;
+      }
+    }
+    return result;
+  }
+
+  /**
+   * 取声明节点中声明的变量名
+   */
+  private declaredName(node: ASTNode): string | null {
+    if (node.type === 'init_declarator') {
+      return this.baseIdentifierOfDeclarator(node.namedChildren[0]);
+    }
+    for (const child of node.namedChildren) {
+      if (child.type === 'identifier' || child.type === 'pointer_declarator' || child.type === 'array_declarator') {
+        return this.baseIdentifierOfDeclarator(child);
+      }
+    }
+    return null;
+  }
+
+  private baseIdentifierOfDeclarator(node: ASTNode | undefined): string | null {
+    let current = node;
+    while (current) {
+      if (current.type === 'identifier') {
+        return current.text;
+      }
+      current = current.namedChildren.find(c => c.type === 'identifier' ||
+        c.type.endsWith('_declarator'));
+    }
+    return null;
+  }
+
+  private isInsideSizeof(node: ASTNode, stop: ASTNode): boolean {
+    let current = node.parent;
+    while (current && current !== stop) {
+      if (current.type === 'sizeof_expression') return true;
+      current = current.parent;
+    }
+    return false;
+  }
+
+  /**
+   * 查找指定类型的子节点
+   */
+  private findChildByType(node: ASTNode, type: string): ASTNode | null {
+    for (const child of node.namedChildren) {
+      if (child.type === type) {
+        return child;
+      }
+    }
+    return null;
+  }
+
+  /**
+   * 遍历 AST 节点
+   */
+  private traverseNode(node: ASTNode, callback: (node: ASTNode) => void): void {
+    callback(node);
+    for (const child of node.namedChildren) {
+      this.traverseNode(child, callback);
+    }
+  }
+}
+
+/**
+ * 不会修改调用方全局变量的常见库函数（输出、内存管理等）
+ */
+const LIBRARY_SIDE_EFFECT_FREE_GLOBALS = new Set([
+  'printf', 'fprintf', 'sprintf', 'snprintf', 'puts', 'fputs', 'putchar', 'fputc',
+  'malloc', 'calloc', 'realloc', 'free', 'memcpy', 'memmove', 'memset',
+  'strcpy', 'strncpy', 'strcat', 'strncat'
+]);
@@ -0,0 +1,118 @@
+import { GitBlobReader, listRevisionBlobs } from './git_source';
+import { ResultCache } from './result_cache';
+import { SymbolSummary, changedDefinitions, mayMention, scanSymbols, summarizeSymbols } from './symbol_index';
+
+export interface MentionOptions {
+  extensions?: string[];    // 默认 ['.c', '.h']
+  pathPrefix?: string;      // 只查找该仓库相对目录下的文件
+  cache?: ResultCache;
+}
+
+export interface MentionResult {
+  files: Array<{ path: string; defines: string[] }>;  // 确实提到任一符号的文件，以及其中定义了哪些
+  total: number;            // 提交中的文件数
+  candidates: number;       // 过滤器判定可能提到、需要读取内容确认的文件数
+  unsummarized: number;     // 缓存中没有标识符摘要、只能直接读取的文件数
+}
+
+/**
+ * 在某个提交中查找提到（引用或定义）给定符号的文件
+ * 已分析过的 blob 在缓存中带有标识符 Bloom 过滤器，过滤器判定不含这些符号的文件不读取内容；
+ * 其余文件经 git cat-file --batch 读出后做一次词法扫描确认，排除过滤器的误报
+ */
+export async function findMentions(repoDir: string, rev: string, names: string[],
+                                   options: MentionOptions = {}): Promise<MentionResult> {
+  const cache = options.cache || new ResultCache();
+  const prefix = options.pathPrefix ? `${options.pathPrefix.replace(/\/+$/, '')}/` : '';
+  const blobs = (await listRevisionBlobs(repoDir, rev, options.extensions || ['.c', '.h']))
+    .filter(blob => blob.path.startsWith(prefix));
+
+  let unsummarized = 0;
+  const candidates = blobs.filter(blob => {
+    const summary = cache.getSymbols(blob.blob);
+    if (!summary) unsummarized++;
+    return !summary || mayMention(summary, names);
+  });
+
+  const result: MentionResult = { files: [], total: blobs.length, candidates: candidates.length, unsummarized };
+  if (candidates.length === 0) return result;
+
+  const reader = new GitBlobReader(repoDir);
+  try {
+    const contents = await Promise.all(candidates.map(blob => reader.read(blob.blob)));
+    candidates.forEach((blob, i) => {
+      const content = contents[i];
+      if (!content) return;
+      const { referenced, defined } = scanSymbols(content.toString('utf8'));
+      if (names.some(name => referenced.has(name) || defined.has(name))) {
+        result.files.push({ path: blob.path, defines: names.filter(name => defined.has(name)) });
+      }
+    });
+  } finally {
+    reader.close();
+  }
+  return result;
+}
+
+export interface AffectedResult {
+  changed: string[];                // base 与 rev 之间内容不同的文件（仓库相对路径）
+  definitions: string[];            // 其中新增、删除或定义文本改变的文件级定义
+  mentions: MentionResult | null;   // 提到这些定义、需要重新检查的文件；没有定义变化时为 null
+}
+
+/**
+ * 从 base 到 rev 需要重新检查的文件：比较内容变化的文件前后两版的标识符摘要，得到定义发生变化的符号，
+ * 再用 findMentions 找出 rev 中提到这些符号的文件；定义文本没有变化（如只改了定义之外的注释或空白）的文件不会牵连其他文件
+ * 变化文件的摘要优先取缓存，没有时读出内容现场计算
+ */
+export async function findAffected(repoDir: string, base: string, rev: string,
+                                   options: MentionOptions = {}): Promise<AffectedResult> {
+  const cache = options.cache || new ResultCache();
+  const extensions = options.extensions || ['.c', '.h'];
+  const [before, after] = await Promise.all([
+    listRevisionBlobs(repoDir, base, extensions),
+    listRevisionBlobs(repoDir, rev, extensions)
+  ]);
+  const beforeByPath = new Map(before.map(blob => [blob.path, blob.blob]));
+  const afterByPath = new Map(after.map(blob => [blob.path, blob.blob]));
+  const changed = Array.from(new Set([...beforeByPath.keys(), ...afterByPath.keys()]))
+    .filter(file => beforeByPath.get(file) !== afterByPath.get(file))
+    .sort();
+
+  const summaries = new Map<string, SymbolSummary | null>();
+  const missing: string[] = [];
+  for (const file of changed) {
+    for (const blob of [beforeByPath.get(file), afterByPath.get(file)]) {
+      if (!blob || summaries.has(blob)) continue;
+      const summary = cache.getSymbols(blob);
+      summaries.set(blob, summary);
+      if (!summary) missing.push(blob);
+    }
+  }
+  if (missing.length > 0) {
+    const reader = new GitBlobReader(repoDir);
+    try {
+      const contents = await Promise.all(missing.map(blob => reader.read(blob)));
+      missing.forEach((blob, i) => {
+        const content = contents[i];
+        if (content) summaries.set(blob, summarizeSymbols(content.toString('utf8')));
+      });
+    } finally {
+      reader.close();
+    }
+  }
+
+  const definitions = new Set<string>();
+  const summaryOf = (blob: string | undefined) => blob ? summaries.get(blob) || null : null;
+  for (const file of changed) {
+    changedDefinitions(summaryOf(beforeByPath.get(file)), summaryOf(afterByPath.get(file)))
+      .forEach(name => definitions.add(name));
+  }
+
+  const names = Array.from(definitions).sort();
+  return {
+    changed,
+    definitions: names,
+    mentions: names.length > 0 ? await findMentions(repoDir, rev, names, { ...options, cache }) : null
+  };
+}
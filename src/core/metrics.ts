@@ -0,0 +1,163 @@
+import * as http from 'http';
+import { monitorEventLoopDelay } from 'perf_hooks';
+import type { IntervalHistogram } from 'perf_hooks';
+
+// 请求耗时直方图的桶上界（秒）
+const REQUEST_BUCKETS = [0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10];
+// files/s 的统计窗口
+const RATE_WINDOW_MS = 60 * 1000;
+
+/**
+ * 累积直方图（Prometheus histogram 语义：每个桶计数所有 ≤ 上界的观测值）
+ */
+export class Histogram {
+  private bounds: number[];
+  private counts: number[];
+  private sum = 0;
+  private count = 0;
+
+  constructor(bounds: number[]) {
+    this.bounds = bounds;
+    this.counts = bounds.map(() => 0);
+  }
+
+  observe(value: number): void {
+    for (let i = 0; i < this.bounds.length; i++) {
+      if (value <= this.bounds[i]) this.counts[i]++;
+    }
+    this.sum += value;
+    this.count++;
+  }
+
+  render(name: string, help: string): string[] {
+    const lines = [`# HELP ${name} ${help}`, `# TYPE ${name} histogram`];
+    this.bounds.forEach((bound, i) => lines.push(`${name}_bucket{le="${bound}"} ${this.counts[i]}`));
+    lines.push(`${name}_bucket{le="+Inf"} ${this.count}`);
+    lines.push(`${name}_sum ${this.sum}`);
+    lines.push(`${name}_count ${this.count}`);
+    return lines;
+  }
+}
+
+/**
+ * 常驻分析进程的运行指标，按 Prometheus 文本格式（0.0.4）导出
+ * 由 daemon 在处理请求时更新；进程内存和事件循环延迟在抓取时读取
+ */
+export class DaemonMetrics {
+  readonly requestSeconds = new Histogram(REQUEST_BUCKETS);
+  requests = 0;
+  requestErrors = 0;
+  queueDepth = 0;           // 已收到、尚未完成的请求数（所有连接）
+  cacheHits = 0;
+  cacheMisses = 0;
+  filesAnalyzed = 0;
+  private recent: number[] = [];    // 窗口内每次完成分析的时间戳
+  private loopDelay: IntervalHistogram;
+
+  constructor() {
+    this.loopDelay = monitorEventLoopDelay({ resolution: 20 });
+    this.loopDelay.enable();
+  }
+
+  recordAnalysis(): void {
+    this.filesAnalyzed++;
+    const now = Date.now();
+    this.recent.push(now);
+    this.prune(now);
+  }
+
+  /**
+   * 生成文本格式的全部指标；detectorSeconds 为分析引擎中各检测器的累计耗时
+   */
+  render(detectorSeconds: Map<string, number>): string {
+    const now = Date.now();
+    this.prune(now);
+    const lookups = this.cacheHits + this.cacheMisses;
+    const memory = process.memoryUsage();
+
+    const lines: string[] = [
+      ...counter('cscan_requests_total', '收到的分析请求数', this.requests),
+      ...counter('cscan_request_errors_total', '失败的分析请求数', this.requestErrors),
+      ...this.requestSeconds.render('cscan_request_duration_seconds', '单个请求从开始处理到写回结果的耗时'),
+      ...gauge('cscan_queue_depth', '已收到、尚未完成的请求数', this.queueDepth),
+      ...counter('cscan_cache_hits_total', '命中内容哈希缓存的请求数', this.cacheHits),
+      ...counter('cscan_cache_misses_total', '未命中缓存、需要分析的请求数', this.cacheMisses),
+      ...gauge('cscan_cache_hit_ratio', '缓存命中率（启动以来）', lookups > 0 ? this.cacheHits / lookups : 0),
+      ...counter('cscan_files_analyzed_total', '实际分析的文件数', this.filesAnalyzed),
+      ...gauge('cscan_files_per_second', `最近 ${RATE_WINDOW_MS / 1000} 秒内平均每秒分析的文件数`,
+        this.recent.length / (RATE_WINDOW_MS / 1000)),
+      ...gauge('process_resident_memory_bytes', '进程常驻内存（RSS）', memory.rss),
+      ...gauge('nodejs_heap_used_bytes', 'V8 堆已用字节数', memory.heapUsed),
+      '# HELP cscan_event_loop_lag_seconds 事件循环延迟（启动以来的分位数与最大值）',
+      '# TYPE cscan_event_loop_lag_seconds gauge',
+      `cscan_event_loop_lag_seconds{quantile="0.5"} ${nanosToSeconds(this.loopDelay.percentile(50))}`,
+      `cscan_event_loop_lag_seconds{quantile="0.99"} ${nanosToSeconds(this.loopDelay.percentile(99))}`,
+      `cscan_event_loop_lag_seconds{quantile="1"} ${nanosToSeconds(this.loopDelay.max)}`,
+      '# HELP cscan_detector_seconds_total 各检测器累计耗时',
+      '# TYPE cscan_detector_seconds_total counter'
+    ];
+    for (const [detector, seconds] of detectorSeconds) {
+      lines.push(`cscan_detector_seconds_total{detector="${detector}"} ${seconds}`);
+    }
+    return lines.join('\n') + '\n';
+  }
+
+  close(): void {
+    this.loopDelay.disable();
+  }
+
+  private prune(now: number): void {
+    let expired = 0;
+    while (expired < this.recent.length && now - this.recent[expired] > RATE_WINDOW_MS) expired++;
+    if (expired > 0) this.recent.splice(0, expired);
+  }
+}
+
+/**
+ * 解析 --metrics 的值：端口号或 主机:端口 时监听 TCP（主机默认 127.0.0.1），其余视为 Unix 域套接字路径
+ * 指标中含有文件处理速率等信息且端点没有认证，主机只允许回环地址（127.0.0.0/8、::1、localhost），其余地址抛出错误
+ */
+export function parseMetricsAddress(spec: string): { host: string; port: number } | { path: string } {
+  const match = spec.match(/^(?:(.*):)?(\d+)$/);
+  if (match) {
+    const host = (match[1] || '127.0.0.1').replace(/^\[(.*)\]$/, '$1');
+    if (!isLoopbackHost(host)) {
+      throw new Error(`--metrics 只能监听回环地址（127.0.0.0/8、::1、localhost）或 Unix 域套接字: ${spec}`);
+    }
+    return { host, port: parseInt(match[2], 10) };
+  }
+  return { path: spec };
+}
+
+function isLoopbackHost(host: string): boolean {
+  if (host === 'localhost' || host === '::1') return true;
+  const octets = host.split('.');
+  return octets.length === 4 && octets[0] === '127' && octets.every(octet => /^\d{1,3}$/.test(octet) && parseInt(octet, 10) <= 255);
+}
+
+/**
+ * 指标端点的 HTTP 服务：GET /metrics 返回 render() 的结果，其余路径返回 404
+ */
+export function createMetricsServer(render: () => string): http.Server {
+  return http.createServer((request, response) => {
+    if (request.method !== 'GET' || (request.url || '').split('?')[0] !== '/metrics') {
+      response.writeHead(404, { 'Content-Type': 'text/plain; charset=utf-8' });
+      response.end('not found\n');
+      return;
+    }
+    response.writeHead(200, { 'Content-Type': 'text/plain; version=0.0.4; charset=utf-8' });
+    response.end(render());
+  });
+}
+
+function counter(name: string, help: string, value: number): string[] {
+  return [`# HELP ${name} ${help}`, `# TYPE ${name} counter`, `${name} ${value}`];
+}
+
+function gauge(name: string, help: string, value: number): string[] {
+  return [`# HELP ${name} ${help}`, `# TYPE ${name} gauge`, `${name} ${value}`];
+}
+
+function nanosToSeconds(value: number): number {
+  return Number.isFinite(value) ? value / 1e9 : 0;
+}
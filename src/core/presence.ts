@@ -0,0 +1,347 @@
+import * as fs from 'fs';
+
+// 配置用位掩码表示
+const MAX_CONFIGURATIONS = 30;
+const MAX_EXPANSION_DEPTH = 8;
+
+/**
+ * 一个构建配置：名称和预定义的宏（相当于一组 -D 选项）
+ */
+export interface BuildConfiguration {
+  name: string;
+  defines: Map<string, string>;
+}
+
+/**
+ * 解析 --configs 的值：JSON 文件 {"linux": {"__linux__": 1, "USE_SSL": "1"}, "win": {"_WIN32": 1}}，
+ * 或内联写法 "linux:__linux__,USE_SSL=1;win:_WIN32"（只写宏名时值为 1）
+ */
+export function parseConfigurations(spec: string): BuildConfiguration[] {
+  const configurations: BuildConfiguration[] = [];
+  if (fs.existsSync(spec) && fs.statSync(spec).isFile()) {
+    const json = JSON.parse(fs.readFileSync(spec, 'utf8'));
+    for (const name of Object.keys(json)) {
+      const defines = new Map<string, string>();
+      for (const [macro, value] of Object.entries(json[name] || {})) {
+        defines.set(macro, value === true ? '1' : String(value));
+      }
+      configurations.push({ name, defines });
+    }
+  } else {
+    for (const part of spec.split(';')) {
+      if (!part.trim()) continue;
+      const colon = part.indexOf(':');
+      const name = (colon >= 0 ? part.slice(0, colon) : part).trim();
+      const defines = new Map<string, string>();
+      for (const define of (colon >= 0 ? part.slice(colon + 1) : '').split(',')) {
+        if (!define.trim()) continue;
+        const eq = define.indexOf('=');
+        defines.set((eq >= 0 ? define.slice(0, eq) : define).trim(), eq >= 0 ? define.slice(eq + 1).trim() : '1');
+      }
+      configurations.push({ name, defines });
+    }
+  }
+  if (configurations.length === 0) {
+    throw new Error(`没有解析出任何构建配置: ${spec}`);
+  }
+  if (configurations.length > MAX_CONFIGURATIONS) {
+    throw new Error(`最多支持 ${MAX_CONFIGURATIONS} 个构建配置`);
+  }
+  return configurations;
+}
+
+interface ConditionalFrame {
+  previous: string[];   // 之前各分支的条件
+  current: string;      // 当前分支的条件（'' 表示 #else）
+  guard?: boolean;      // 头文件保护（#ifndef X / #define X），不计入条件文本
+}
+
+interface ConfigFrame {
+  parentActive: boolean;
+  taken: boolean;       // 之前是否已有分支生效
+  active: boolean;
+}
+
+/**
+ * 单个文件中每一行的存在条件：#if/#ifdef/#elif/#else 构成的条件文本，以及在各构建配置下是否生效
+ * 各配置只做一遍按行的条件求值（处理文件内的 #define/#undef），不重复解析和检测，
+ * 因此 N 个配置的开销接近一次扫描
+ */
+export class PresenceMap {
+  private configurations: BuildConfiguration[];
+  private masks: number[] = [];
+  private conditions: string[] = [];
+
+  private constructor(configurations: BuildConfiguration[]) {
+    this.configurations = configurations;
+  }
+
+  static build(sourceCode: string, configurations: BuildConfiguration[]): PresenceMap {
+    const map = new PresenceMap(configurations);
+    const lines = sourceCode.split(/\r?\n/);
+    const symbolic: ConditionalFrame[] = [];
+    const states = configurations.map(config => ({ defines: new Map(config.defines), stack: [] as ConfigFrame[] }));
+
+    for (let i = 0; i < lines.length; i++) {
+      // 续行：指令以反斜杠结尾时与下一行合并，合并的各行使用同一结果
+      let text = lines[i];
+      let last = i;
+      while (/\\\s*$/.test(text) && last + 1 < lines.length) {
+        text = text.replace(/\\\s*$/, ' ') + lines[++last];
+      }
+      const directive = text.match(/^\s*#\s*(\w+)\s*(.*)$/);
+
+      // 指令行本身按其所在的外层条件记录
+      const before = map.currentMask(states);
+      const beforeCondition = conditionText(symbolic);
+      if (directive) {
+        const keyword = directive[1];
+        const argument = stripComments(directive[2]).replace(/\s+/g, ' ').trim();
+        map.applySymbolic(symbolic, keyword, argument);
+        states.forEach(state => applyDirective(state, keyword, argument));
+      }
+      for (let line = i; line <= last; line++) {
+        map.masks[line] = directive ? before : map.currentMask(states);
+        map.conditions[line] = directive ? beforeCondition : conditionText(symbolic);
+      }
+      i = last;
+    }
+    return map;
+  }
+
+  /**
+   * 该行在哪些配置下存在（行号从 1 开始）
+   * 给出 origin（引起问题的声明或赋值所在行）时取两行同时存在的配置
+   */
+  configurationsAt(line: number, origin?: number): string[] {
+    const mask = this.maskAt(line) & (origin ? this.maskAt(origin) : ~0);
+    return this.configurations.filter((_, i) => (mask & (1 << i)) !== 0).map(config => config.name);
+  }
+
+  /**
+   * 该行在所有配置下都存在
+   */
+  inAllConfigurations(line: number): boolean {
+    return this.maskAt(line) === (1 << this.configurations.length) - 1;
+  }
+
+  /**
+   * 该行的存在条件，如 "defined(USE_SSL) && !(defined(_WIN32))"；无条件时为空串
+   * 给出 origin 时与该行的条件合取（相同的条件只写一次）
+   */
+  conditionAt(line: number, origin?: number): string {
+    const own = this.conditions[line - 1] || '';
+    const other = origin ? this.conditions[origin - 1] || '' : '';
+    if (!other || other === own) return own;
+    return own ? `${own} && ${other}` : other;
+  }
+
+  private maskAt(line: number): number {
+    const mask = this.masks[line - 1];
+    return mask === undefined ? (1 << this.configurations.length) - 1 : mask;
+  }
+
+  private currentMask(states: Array<{ stack: ConfigFrame[] }>): number {
+    let mask = 0;
+    states.forEach((state, i) => {
+      const top = state.stack[state.stack.length - 1];
+      if (!top || top.active) mask |= 1 << i;
+    });
+    return mask;
+  }
+
+  private applySymbolic(stack: ConditionalFrame[], keyword: string, argument: string): void {
+    const top = stack[stack.length - 1];
+    switch (keyword) {
+      case 'if':
+        stack.push({ previous: [], current: argument });
+        break;
+      case 'ifdef':
+        stack.push({ previous: [], current: `defined(${firstWord(argument)})` });
+        break;
+      case 'ifndef':
+        stack.push({ previous: [], current: `!defined(${firstWord(argument)})` });
+        break;
+      case 'elif':
+        if (top) {
+          top.previous.push(top.current);
+          top.current = argument;
+        }
+        break;
+      case 'else':
+        if (top) {
+          top.previous.push(top.current);
+          top.current = '';
+        }
+        break;
+      case 'endif':
+        stack.pop();
+        break;
+      case 'define':
+        if (stack.length === 1 && top.previous.length === 0 && top.current === `!defined(${firstWord(argument)})`) {
+          top.guard = true;
+        }
+        break;
+    }
+  }
+}
+
+/**
+ * 在一个配置下处理条件指令和宏定义；只有生效区域内的 #define/#undef 才改变宏表
+ */
+function applyDirective(state: { defines: Map<string, string>; stack: ConfigFrame[] }, keyword: string, argument: string): void {
+  const top = state.stack[state.stack.length - 1];
+  const active = !top || top.active;
+  switch (keyword) {
+    case 'if':
+    case 'ifdef':
+    case 'ifndef': {
+      let value = false;
+      if (active) {
+        value = keyword === 'if'
+          ? evaluateCondition(argument, state.defines) !== 0
+          : state.defines.has(firstWord(argument)) === (keyword === 'ifdef');
+      }
+      state.stack.push({ parentActive: active, taken: value, active: value });
+      break;
+    }
+    case 'elif':
+      if (top) {
+        const value = top.parentActive && !top.taken && evaluateCondition(argument, state.defines) !== 0;
+        top.active = value;
+        top.taken = top.taken || value;
+      }
+      break;
+    case 'else':
+      if (top) {
+        top.active = top.parentActive && !top.taken;
+        top.taken = true;
+      }
+      break;
+    case 'endif':
+      state.stack.pop();
+      break;
+    case 'define':
+      if (active) {
+        const match = argument.match(/^(\w+)(\([^)]*\))?\s*(.*)$/);
+        if (match) state.defines.set(match[1], match[2] ? FUNCTION_LIKE : match[3]);
+      }
+      break;
+    case 'undef':
+      if (active) state.defines.delete(firstWord(argument));
+      break;
+  }
+}
+
+// 函数式宏的占位值：在 #if 中调用时无法求值，按 0 处理
+const FUNCTION_LIKE = '\0function-like';
+
+function conditionText(stack: ConditionalFrame[]): string {
+  const terms: string[] = [];
+  for (const frame of stack) {
+    if (frame.guard) continue;
+    for (const previous of frame.previous) {
+      terms.push(`!(${previous})`);
+    }
+    if (frame.current) {
+      terms.push(/^!?defined\(\w+\)$/.test(frame.current) ? frame.current : `(${frame.current})`);
+    }
+  }
+  return terms.join(' && ');
+}
+
+function firstWord(text: string): string {
+  const match = text.match(/^\w+/);
+  return match ? match[0] : '';
+}
+
+function stripComments(text: string): string {
+  return text.replace(/\/\*.*?\*\//g, ' ').replace(/\/\/.*$/, '');
+}
+
+// 二元运算符：优先级与求值函数
+const BINARY: { [op: string]: [number, (a: number, b: number) => number] } = {
+  '*': [10, (a, b) => a * b], '/': [10, (a, b) => (b === 0 ? 0 : Math.trunc(a / b))], '%': [10, (a, b) => (b === 0 ? 0 : a % b)],
+  '+': [9, (a, b) => a + b], '-': [9, (a, b) => a - b],
+  '<<': [8, (a, b) => a << b], '>>': [8, (a, b) => a >> b],
+  '<': [7, (a, b) => +(a < b)], '>': [7, (a, b) => +(a > b)], '<=': [7, (a, b) => +(a <= b)], '>=': [7, (a, b) => +(a >= b)],
+  '==': [6, (a, b) => +(a === b)], '!=': [6, (a, b) => +(a !== b)],
+  '&': [5, (a, b) => a & b], '^': [4, (a, b) => a ^ b], '|': [3, (a, b) => a | b],
+  '&&': [2, (a, b) => +(a !== 0 && b !== 0)], '||': [1, (a, b) => +(a !== 0 || b !== 0)]
+};
+
+/**
+ * 预处理器常量表达式求值：defined、整数/字符字面量、宏展开（对象式宏递归求值）以及 C 的运算符
+ * 未定义的标识符按 C 规则视为 0
+ */
+export function evaluateCondition(expression: string, defines: Map<string, string>, depth: number = 0): number {
+  const tokens = expression.match(/0[xX][0-9a-fA-F]+|\d+|'(?:\\.|[^'])'|\w+|&&|\|\||<<|>>|<=|>=|==|!=|[-+*\/%<>!~&|^?:()]/g) || [];
+  let position = 0;
+
+  const peek = () => tokens[position];
+  const next = () => tokens[position++];
+
+  const primary = (): number => {
+    const token = next();
+    if (token === undefined) return 0;
+    if (token === '(') {
+      const value = ternary();
+      if (peek() === ')') next();
+      return value;
+    }
+    if (token === '!') return primary() === 0 ? 1 : 0;
+    if (token === '~') return ~primary();
+    if (token === '-') return -primary();
+    if (token === '+') return primary();
+    if (token === 'defined') {
+      const parenthesized = peek() === '(';
+      if (parenthesized) next();
+      const name = next();
+      if (parenthesized && peek() === ')') next();
+      return defines.has(name) ? 1 : 0;
+    }
+    if (/^\d/.test(token)) {
+      return parseInt(token.replace(/[uUlL]+$/, ''), /^0[xX]/.test(token) ? 16 : /^0\d/.test(token) ? 8 : 10) || 0;
+    }
+    if (token.startsWith("'")) {
+      return token.length === 3 ? token.charCodeAt(1) : 0;
+    }
+    // 标识符：函数式调用跳过参数，对象式宏递归求值
+    if (peek() === '(') {
+      let level = 0;
+      do {
+        const t = next();
+        if (t === '(') level++;
+        if (t === ')') level--;
+      } while (level > 0 && position < tokens.length);
+      return 0;
+    }
+    const value = defines.get(token);
+    if (value === undefined || value === FUNCTION_LIKE || depth >= MAX_EXPANSION_DEPTH) return 0;
+    return evaluateCondition(value, defines, depth + 1);
+  };
+
+  const binary = (minPrecedence: number): number => {
+    let left = primary();
+    while (true) {
+      const token = peek();
+      const op = token !== undefined && Object.prototype.hasOwnProperty.call(BINARY, token) ? BINARY[token] : undefined;
+      if (!op || op[0] < minPrecedence) return left;
+      next();
+      const right = binary(op[0] + 1);
+      left = op[1](left, right);
+    }
+  };
+
+  const ternary = (): number => {
+    const condition = binary(1);
+    if (peek() !== '?') return condition;
+    next();
+    const whenTrue = ternary();
+    if (peek() === ':') next();
+    const whenFalse = ternary();
+    return condition !== 0 ? whenTrue : whenFalse;
+  };
+
+  return ternary();
+}
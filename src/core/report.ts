@@ -5,10 +5,10 @@ import { runClangTidy } from './clang';
 import * as os from 'os';
 
 // AST版本的分析目录函数
-function analyzeDir(dir: string): Issue[] {
+function analyzeDir(dir: string, extensions: string[]): Issue[] {
   // 这里需要调用AST版本的分析
   // 目前暂时返回空数组，实际应该调用AST扫描器
-  const files = fs.readdirSync(dir).filter(f => f.endsWith('.c'));
+  const files = fs.readdirSync(dir).filter(f => extensions.some(ext => f.endsWith(ext)));
   const issues: Issue[] = [];
   
   // TODO: 这里应该调用AST扫描器
@@ -19,9 +19,12 @@ function analyzeDir(dir: string): Issue[] {
 
 type Metrics = { TP: number; FP: number; FN: number; Precision: number; Recall: number; F1: number; totalIssues: number; totalBugs: number };
 
+// --headers：头文件也参与评测（头文件中的预置 BUG 计入总数）
+const SOURCE_EXTENSIONS = process.argv.includes('--headers') ? ['.c', '.h'] : ['.c'];
+
 function collectBugLines(dir: string): Map<string, Set<number>> {
   const map = new Map<string, Set<number>>();
-  const files = fs.readdirSync(dir).filter(f => f.endsWith('.c'));
+  const files = fs.readdirSync(dir).filter(f => SOURCE_EXTENSIONS.some(ext => f.endsWith(ext)));
   for (const f of files) {
     const p = path.join(dir, f);
     const lines = fs.readFileSync(p, 'utf8').split(/\r?\n/);
@@ -142,12 +145,13 @@ function writeRunLog(targetDir: string, issues: Issue[]) {
 }
 
 async function main() {
-  const target = process.argv[2] ? path.resolve(process.argv[2]) : path.resolve(process.cwd(), 'tests/graphs/buggy');
-  const issues = analyzeDir(target);
+  const targetArg = process.argv.slice(2).find(arg => !arg.startsWith('--'));
+  const target = targetArg ? path.resolve(targetArg) : path.resolve(process.cwd(), 'tests/graphs/buggy');
+  const issues = analyzeDir(target, SOURCE_EXTENSIONS);
   // merge clang-tidy issues (best-effort)
   let merged = issues;
   try {
-    const clangIssues = runClangTidy(target);
+    const clangIssues = runClangTidy(target, SOURCE_EXTENSIONS.includes('.h'));
     // Try to map clang categories into local types by heuristic
     const remapped = clangIssues.map(it => {
       const msg = it.message.toLowerCase();
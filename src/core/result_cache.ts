@@ -0,0 +1,127 @@
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { ENGINE_VERSION, IssueRecord, issueFingerprint } from './engine';
+import { SymbolSummary } from './symbol_index';
+
+/**
+ * 缓存中的问题记录不含文件路径：同一内容出现在不同路径时可以复用，取出时再补上路径与指纹
+ */
+export type CachedIssue = Omit<IssueRecord, 'file' | 'fingerprint'>;
+
+/**
+ * 缓存条目：问题记录以及文件的标识符摘要（旧版本写入的条目只有问题数组）
+ * headers 为分析时用到的本地头文件 -> blob ID（不存在的为 ''）：从 git 对象库分析时键为仓库相对路径，daemon 分析工作区文件时为绝对路径
+ */
+interface CacheEntry {
+  issues: CachedIssue[];
+  symbols?: SymbolSummary;
+  headers?: { [path: string]: string };
+}
+
+/**
+ * 当前用户专属的缓存目录：<临时目录>/<name>-<uid>，以 0700 创建
+ * 目录已存在但不属于当前用户或其他用户可以访问时拒绝使用，避免读入他人预先放置的结果
+ */
+export function userCacheDir(name: string): string {
+  const user = os.userInfo();
+  const dir = path.join(os.tmpdir(), `${name}-${user.uid >= 0 ? user.uid : user.username}`);
+  fs.mkdirSync(dir, { recursive: true, mode: 0o700 });
+  if (process.platform !== 'win32') {
+    const stat = fs.lstatSync(dir);
+    if (!stat.isDirectory() || stat.uid !== user.uid || (stat.mode & 0o077) !== 0) {
+      throw new Error(`缓存目录 ${dir} 不属于当前用户或权限过宽，拒绝使用`);
+    }
+  }
+  return dir;
+}
+
+/**
+ * 按内容哈希（git blob ID 或 sha1）缓存单个文件的分析结果
+ * 键中包含 ENGINE_VERSION，检测器更新后旧结果自动失效；每个键一个 JSON 文件，按前两位分目录
+ * 默认目录为当前用户专属的临时目录（见 userCacheDir）
+ */
+export class ResultCache {
+  private dir: string;
+
+  constructor(dir: string = userCacheDir('cscan-result-cache')) {
+    this.dir = path.join(dir, `v${ENGINE_VERSION}`);
+  }
+
+  has(contentHash: string): boolean {
+    return fs.existsSync(this.entryPath(contentHash));
+  }
+
+  /**
+   * 取出缓存结果并还原为 filePath 下的问题记录；未命中时返回 null
+   * 给出 headerBlobs（某个提交中仓库相对路径 -> blob ID）时，只接受分析时所用本地头文件与之一致的条目
+   */
+  get(contentHash: string, filePath: string, headerBlobs?: Map<string, string>): IssueRecord[] | null {
+    const entry = this.readEntry(contentHash);
+    if (!entry) return null;
+    if (headerBlobs) {
+      if (!entry.headers) return null;
+      for (const header of Object.keys(entry.headers)) {
+        if ((headerBlobs.get(header) || '') !== entry.headers[header]) return null;
+      }
+    }
+    return this.restore(entry, filePath);
+  }
+
+  /**
+   * 与 get 相同，但只接受所记录的本地头文件与 headers 完全一致（路径集合与 blob ID 都相同）的条目
+   * 供 daemon 分析工作区文件时使用：headers 为头文件绝对路径 -> 当前内容的 blob ID，不存在的为 ''
+   */
+  getMatching(contentHash: string, filePath: string, headers: { [path: string]: string }): IssueRecord[] | null {
+    const entry = this.readEntry(contentHash);
+    if (!entry || !entry.headers) return null;
+    const recorded = Object.keys(entry.headers);
+    if (recorded.length !== Object.keys(headers).length) return null;
+    for (const header of recorded) {
+      if (headers[header] !== entry.headers[header]) return null;
+    }
+    return this.restore(entry, filePath);
+  }
+
+  /**
+   * 取出缓存的标识符摘要；条目不存在或写入时没有摘要时返回 null
+   */
+  getSymbols(contentHash: string): SymbolSummary | null {
+    const entry = this.readEntry(contentHash);
+    return entry && entry.symbols ? entry.symbols : null;
+  }
+
+  set(contentHash: string, issues: IssueRecord[], symbols?: SymbolSummary, headers?: { [path: string]: string }): void {
+    const entry: CacheEntry = { issues: issues.map(({ file, fingerprint, ...rest }) => rest) };
+    if (symbols) entry.symbols = symbols;
+    if (headers) entry.headers = headers;
+    const target = this.entryPath(contentHash);
+    fs.mkdirSync(path.dirname(target), { recursive: true, mode: 0o700 });
+    // 先写临时文件再改名，避免并发读到半个文件
+    const tmp = `${target}.${process.pid}.tmp`;
+    fs.writeFileSync(tmp, JSON.stringify(entry), 'utf8');
+    fs.renameSync(tmp, target);
+  }
+
+  private restore(entry: CacheEntry, filePath: string): IssueRecord[] {
+    return entry.issues.map((issue): IssueRecord => ({
+      ...issue,
+      file: filePath,
+      fingerprint: issueFingerprint(filePath, issue.category, issue.message, issue.codeLine)
+    }));
+  }
+
+  private readEntry(contentHash: string): CacheEntry | null {
+    let parsed: any;
+    try {
+      parsed = JSON.parse(fs.readFileSync(this.entryPath(contentHash), 'utf8'));
+    } catch {
+      return null;
+    }
+    return Array.isArray(parsed) ? { issues: parsed } : parsed;
+  }
+
+  private entryPath(contentHash: string): string {
+    return path.join(this.dir, contentHash.slice(0, 2), `${contentHash.slice(2)}.json`);
+  }
+}
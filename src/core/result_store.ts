@@ -0,0 +1,463 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { Issue } from '../interfaces/types';
+import { issueFingerprint } from './fingerprint';
+
+/**
+ * 结果存储文件格式（小端，全部为 u32，除非另有说明）
+ *
+ *   header      MAGIC、版本、各计数、各节偏移
+ *   strings     字符串偏移表（stringCount + 1 项）+ UTF-8 数据；文件路径、类别、消息、代码行去重后共用
+ *   records     RECORD_SIZE 字节定长记录，按 (文件路径, 行, 列) 排序：
+ *               文件串、行、列(u16)、严重级别(u8)、保留(u8)、类别号、消息串、代码行串、8 字节指纹
+ *   files       (路径串, 首条记录, 记录数)，按路径排序
+ *   categories  (名称串, 倒排表起点, 记录数)，倒排表为升序记录号
+ *   dirs        (路径串, 首条记录, 记录数, 每个类别的计数...)，按路径排序；根目录路径为 ''
+ *   fingerprint (8 字节指纹, 记录号)，按指纹排序
+ *
+ * 路径相对于存储文件所在目录，使用 '/' 分隔。同一目录子树中的文件在排序后连续，
+ * 因此目录和文件查询都只是一个记录区间，类别过滤在该区间上二分倒排表即可
+ */
+const MAGIC = 0x53525343; // 'CSRS'
+const VERSION = 1;
+const HEADER_SIZE = 64;
+const RECORD_SIZE = 32;
+const FILE_ENTRY_SIZE = 12;
+const CATEGORY_ENTRY_SIZE = 12;
+const FINGERPRINT_ENTRY_SIZE = 12;
+
+export interface StoredIssue {
+  file: string;       // 相对存储文件目录的路径
+  line: number;
+  column: number;
+  category: string;
+  message: string;
+  severity: number;
+  codeLine: string;
+  fingerprint: string;
+}
+
+export interface ResultQuery {
+  category?: string;
+  path?: string;          // 文件或目录，相对存储文件目录
+  fingerprint?: string;
+}
+
+export interface DirectoryAggregate {
+  path: string;
+  total: number;
+  byCategory: { [category: string]: number };
+}
+
+interface Header {
+  recordCount: number;
+  stringCount: number;
+  fileCount: number;
+  categoryCount: number;
+  dirCount: number;
+  stringOffsets: number;
+  stringData: number;
+  records: number;
+  files: number;
+  categories: number;
+  postings: number;
+  dirs: number;
+  fingerprints: number;
+}
+
+/**
+ * 结果存储写入器：收集问题记录，finish 时排序、建立索引并原子地写出文件
+ */
+export class ResultStoreWriter {
+  private storePath: string;
+  private baseDir: string;
+  private strings = new Map<string, number>();
+  private stringList: string[] = [];
+  private records: Array<{ file: number; line: number; column: number; category: number; message: number;
+    codeLine: number; severity: number; fingerprint: Buffer }> = [];
+
+  constructor(storePath: string) {
+    this.storePath = path.resolve(storePath);
+    this.baseDir = path.dirname(this.storePath);
+  }
+
+  /**
+   * 添加一条问题；文本回退分析产生的 Issue 没有列号、严重级别和指纹，使用默认值并补算指纹
+   */
+  add(issue: Issue & { column?: number; severity?: number; fingerprint?: string }): void {
+    const fingerprint = issue.fingerprint || issueFingerprint(issue.file, issue.category, issue.message, issue.codeLine);
+    const relative = path.relative(this.baseDir, path.resolve(issue.file)).split(path.sep).join('/');
+    this.records.push({
+      file: this.intern(relative),
+      line: issue.line,
+      column: issue.column || 0,
+      category: this.intern(issue.category),
+      message: this.intern(issue.message),
+      codeLine: this.intern(issue.codeLine),
+      severity: typeof issue.severity === 'number' ? issue.severity : 1,
+      fingerprint: Buffer.from(fingerprint.padEnd(16, '0').slice(0, 16), 'hex')
+    });
+  }
+
+  finish(): void {
+    const str = (id: number) => this.stringList[id];
+    const records = this.records.sort((a, b) =>
+      compare(str(a.file), str(b.file)) || a.line - b.line || a.column - b.column);
+
+    // 文件表
+    const files: Array<{ path: number; first: number; count: number }> = [];
+    records.forEach((record, index) => {
+      const last = files[files.length - 1];
+      if (last && last.path === record.file) {
+        last.count++;
+      } else {
+        files.push({ path: record.file, first: index, count: 1 });
+      }
+    });
+
+    // 类别倒排表
+    const categoryIds = Array.from(new Set(records.map(r => r.category))).sort((a, b) => compare(str(a), str(b)));
+    const categoryIndex = new Map(categoryIds.map((id, i) => [id, i] as [number, number]));
+    const postings: number[][] = categoryIds.map(() => []);
+    records.forEach((record, index) => postings[categoryIndex.get(record.category)!].push(index));
+
+    // 目录表：每个文件的所有祖先目录（含根目录 ''）
+    const dirs = new Map<string, { first: number; end: number; counts: number[] }>();
+    for (const file of files) {
+      const parts = str(file.path).split('/');
+      for (let depth = 0; depth < parts.length; depth++) {
+        const dir = parts.slice(0, depth).join('/');
+        let entry = dirs.get(dir);
+        if (!entry) {
+          entry = { first: file.first, end: file.first, counts: categoryIds.map(() => 0) };
+          dirs.set(dir, entry);
+        }
+        entry.end = file.first + file.count;
+        for (let i = file.first; i < file.first + file.count; i++) {
+          entry.counts[categoryIndex.get(records[i].category)!]++;
+        }
+      }
+    }
+    const dirList = Array.from(dirs.entries()).sort((a, b) => compare(a[0], b[0]));
+    for (const [dir] of dirList) this.intern(dir);
+
+    // 指纹索引
+    const fingerprints = records.map((record, index) => ({ fp: record.fingerprint, index }))
+      .sort((a, b) => Buffer.compare(a.fp, b.fp) || a.index - b.index);
+
+    // 布局
+    const stringBuffers = this.stringList.map(s => Buffer.from(s, 'utf8'));
+    const stringDataSize = stringBuffers.reduce((sum, b) => sum + b.length, 0);
+    const dirEntrySize = 12 + 4 * categoryIds.length;
+    const header: Header = {
+      recordCount: records.length,
+      stringCount: stringBuffers.length,
+      fileCount: files.length,
+      categoryCount: categoryIds.length,
+      dirCount: dirList.length,
+      stringOffsets: HEADER_SIZE,
+      stringData: 0, records: 0, files: 0, categories: 0, postings: 0, dirs: 0, fingerprints: 0
+    };
+    header.stringData = header.stringOffsets + 4 * (stringBuffers.length + 1);
+    header.records = align4(header.stringData + stringDataSize);
+    header.files = header.records + RECORD_SIZE * records.length;
+    header.categories = header.files + FILE_ENTRY_SIZE * files.length;
+    header.postings = header.categories + CATEGORY_ENTRY_SIZE * categoryIds.length;
+    header.dirs = header.postings + 4 * records.length;
+    header.fingerprints = header.dirs + dirEntrySize * dirList.length;
+    const total = header.fingerprints + FINGERPRINT_ENTRY_SIZE * records.length;
+    if (total > 0xffffffff) {
+      throw new Error('结果存储超过 4GB，请按目录拆分扫描');
+    }
+
+    const buf = Buffer.alloc(total);
+    writeHeader(buf, header);
+
+    let offset = 0;
+    stringBuffers.forEach((b, i) => {
+      buf.writeUInt32LE(offset, header.stringOffsets + 4 * i);
+      b.copy(buf, header.stringData + offset);
+      offset += b.length;
+    });
+    buf.writeUInt32LE(offset, header.stringOffsets + 4 * stringBuffers.length);
+
+    records.forEach((record, i) => {
+      const at = header.records + RECORD_SIZE * i;
+      buf.writeUInt32LE(record.file, at);
+      buf.writeUInt32LE(record.line, at + 4);
+      buf.writeUInt16LE(Math.min(record.column, 0xffff), at + 8);
+      buf.writeUInt8(Math.max(0, Math.min(255, record.severity)), at + 10);
+      buf.writeUInt32LE(categoryIndex.get(record.category)!, at + 12);
+      buf.writeUInt32LE(record.message, at + 16);
+      buf.writeUInt32LE(record.codeLine, at + 20);
+      record.fingerprint.copy(buf, at + 24);
+    });
+
+    files.forEach((file, i) => {
+      const at = header.files + FILE_ENTRY_SIZE * i;
+      buf.writeUInt32LE(file.path, at);
+      buf.writeUInt32LE(file.first, at + 4);
+      buf.writeUInt32LE(file.count, at + 8);
+    });
+
+    let postingOffset = 0;
+    categoryIds.forEach((id, i) => {
+      const at = header.categories + CATEGORY_ENTRY_SIZE * i;
+      buf.writeUInt32LE(id, at);
+      buf.writeUInt32LE(postingOffset, at + 4);
+      buf.writeUInt32LE(postings[i].length, at + 8);
+      for (const recordIndex of postings[i]) {
+        buf.writeUInt32LE(recordIndex, header.postings + 4 * postingOffset++);
+      }
+    });
+
+    dirList.forEach(([dir, entry], i) => {
+      const at = header.dirs + dirEntrySize * i;
+      buf.writeUInt32LE(this.strings.get(dir)!, at);
+      buf.writeUInt32LE(entry.first, at + 4);
+      buf.writeUInt32LE(entry.end - entry.first, at + 8);
+      entry.counts.forEach((count, c) => buf.writeUInt32LE(count, at + 12 + 4 * c));
+    });
+
+    fingerprints.forEach((entry, i) => {
+      const at = header.fingerprints + FINGERPRINT_ENTRY_SIZE * i;
+      entry.fp.copy(buf, at);
+      buf.writeUInt32LE(entry.index, at + 8);
+    });
+
+    fs.mkdirSync(path.dirname(this.storePath), { recursive: true });
+    const tmp = `${this.storePath}.${process.pid}.tmp`;
+    fs.writeFileSync(tmp, buf);
+    fs.renameSync(tmp, this.storePath);
+  }
+
+  private intern(value: string): number {
+    let id = this.strings.get(value);
+    if (id === undefined) {
+      id = this.stringList.length;
+      this.strings.set(value, id);
+      this.stringList.push(value);
+    }
+    return id;
+  }
+}
+
+/**
+ * 结果存储读取器：只按需读取索引节和命中的记录（定位读），不把整个文件载入内存
+ */
+export class ResultStoreReader {
+  private fd: number;
+  private header: Header;
+  private baseDir: string;
+  private stringCache = new Map<number, string>();
+  private fileTable: Buffer;       // 文件表原始字节，路径按需解码
+  private categories: Array<{ name: string; postingOffset: number; count: number }>;
+  private dirs: DirectoryAggregate[];
+  private dirRanges: Array<{ first: number; count: number }>;
+
+  constructor(storePath: string) {
+    const resolved = path.resolve(storePath);
+    this.baseDir = path.dirname(resolved);
+    this.fd = fs.openSync(resolved, 'r');
+    const head = this.read(0, HEADER_SIZE);
+    if (head.readUInt32LE(0) !== MAGIC || head.readUInt32LE(4) !== VERSION) {
+      fs.closeSync(this.fd);
+      throw new Error(`${storePath} 不是受支持的结果存储文件`);
+    }
+    this.header = readHeader(head);
+
+    const h = this.header;
+    this.fileTable = this.read(h.files, FILE_ENTRY_SIZE * h.fileCount);
+
+    const catBuf = this.read(h.categories, CATEGORY_ENTRY_SIZE * h.categoryCount);
+    this.categories = [];
+    for (let i = 0; i < h.categoryCount; i++) {
+      const at = CATEGORY_ENTRY_SIZE * i;
+      this.categories.push({ name: this.string(catBuf.readUInt32LE(at)), postingOffset: catBuf.readUInt32LE(at + 4), count: catBuf.readUInt32LE(at + 8) });
+    }
+
+    const dirEntrySize = 12 + 4 * h.categoryCount;
+    const dirBuf = this.read(h.dirs, dirEntrySize * h.dirCount);
+    this.dirs = [];
+    this.dirRanges = [];
+    for (let i = 0; i < h.dirCount; i++) {
+      const at = dirEntrySize * i;
+      const byCategory: { [category: string]: number } = {};
+      this.categories.forEach((category, c) => {
+        const count = dirBuf.readUInt32LE(at + 12 + 4 * c);
+        if (count > 0) byCategory[category.name] = count;
+      });
+      const count = dirBuf.readUInt32LE(at + 8);
+      this.dirs.push({ path: this.string(dirBuf.readUInt32LE(at)), total: count, byCategory });
+      this.dirRanges.push({ first: dirBuf.readUInt32LE(at + 4), count });
+    }
+  }
+
+  close(): void {
+    fs.closeSync(this.fd);
+  }
+
+  get baseDirectory(): string {
+    return this.baseDir;
+  }
+
+  /**
+   * 查询匹配的记录号（升序）
+   */
+  queryIds(query: ResultQuery): number[] {
+    let range = { first: 0, count: this.header.recordCount };
+    if (query.path !== undefined) {
+      const found = this.pathRange(query.path);
+      if (!found) return [];
+      range = found;
+    }
+    const end = range.first + range.count;
+
+    let ids: number[];
+    if (query.category !== undefined) {
+      const category = this.categories.find(c => c.name === query.category);
+      if (!category) return [];
+      // 在倒排表上二分出区间内的部分
+      const postingAt = (i: number) => this.read(this.header.postings + 4 * (category.postingOffset + i), 4).readUInt32LE(0);
+      const lo = lowerBound(category.count, i => postingAt(i) < range.first);
+      const hi = lowerBound(category.count, i => postingAt(i) < end);
+      const slice = this.read(this.header.postings + 4 * (category.postingOffset + lo), 4 * (hi - lo));
+      ids = [];
+      for (let i = 0; i < hi - lo; i++) ids.push(slice.readUInt32LE(4 * i));
+    } else {
+      ids = [];
+      for (let i = range.first; i < end; i++) ids.push(i);
+    }
+
+    if (query.fingerprint !== undefined) {
+      const matches = new Set(this.fingerprintIds(query.fingerprint));
+      ids = ids.filter(id => matches.has(id));
+    }
+    return ids;
+  }
+
+  /**
+   * 读取一条记录
+   */
+  record(id: number): StoredIssue {
+    const buf = this.read(this.header.records + RECORD_SIZE * id, RECORD_SIZE);
+    return {
+      file: this.string(buf.readUInt32LE(0)),
+      line: buf.readUInt32LE(4),
+      column: buf.readUInt16LE(8),
+      severity: buf.readUInt8(10),
+      category: this.categories[buf.readUInt32LE(12)].name,
+      message: this.string(buf.readUInt32LE(16)),
+      codeLine: this.string(buf.readUInt32LE(20)),
+      fingerprint: buf.toString('hex', 24, 32)
+    };
+  }
+
+  /**
+   * 目录聚合：给定目录本身及其直接子目录的计数（来自预先计算的目录索引）
+   */
+  aggregate(dirPath: string = ''): DirectoryAggregate[] {
+    const base = normalize(dirPath);
+    const prefix = base === '' ? '' : `${base}/`;
+    return this.dirs.filter(dir => {
+      if (dir.path === base) return true;
+      if (dir.path === '' || !dir.path.startsWith(prefix)) return false;
+      return !dir.path.slice(prefix.length).includes('/');
+    });
+  }
+
+  /**
+   * 文件或目录对应的记录区间
+   */
+  private pathRange(target: string): { first: number; count: number } | null {
+    const p = normalize(target);
+    const filePath = (i: number) => this.string(this.fileTable.readUInt32LE(FILE_ENTRY_SIZE * i));
+    const fileCount = this.header.fileCount;
+    const fileIndex = lowerBound(fileCount, i => compare(filePath(i), p) < 0);
+    if (fileIndex < fileCount && filePath(fileIndex) === p) {
+      const at = FILE_ENTRY_SIZE * fileIndex;
+      return { first: this.fileTable.readUInt32LE(at + 4), count: this.fileTable.readUInt32LE(at + 8) };
+    }
+    const dirIndex = lowerBound(this.dirs.length, i => compare(this.dirs[i].path, p) < 0);
+    if (dirIndex < this.dirs.length && this.dirs[dirIndex].path === p) {
+      return this.dirRanges[dirIndex];
+    }
+    return null;
+  }
+
+  private fingerprintIds(fingerprint: string): number[] {
+    const key = Buffer.from(fingerprint.padEnd(16, '0').slice(0, 16), 'hex');
+    const n = this.header.recordCount;
+    const at = (i: number) => this.read(this.header.fingerprints + FINGERPRINT_ENTRY_SIZE * i, FINGERPRINT_ENTRY_SIZE);
+    const ids: number[] = [];
+    for (let i = lowerBound(n, i => Buffer.compare(at(i).subarray(0, 8), key) < 0); i < n; i++) {
+      const entry = at(i);
+      if (Buffer.compare(entry.subarray(0, 8), key) !== 0) break;
+      ids.push(entry.readUInt32LE(8));
+    }
+    return ids.sort((a, b) => a - b);
+  }
+
+  private string(id: number): string {
+    let value = this.stringCache.get(id);
+    if (value === undefined) {
+      const offsets = this.read(this.header.stringOffsets + 4 * id, 8);
+      const start = offsets.readUInt32LE(0);
+      const end = offsets.readUInt32LE(4);
+      value = this.read(this.header.stringData + start, end - start).toString('utf8');
+      this.stringCache.set(id, value);
+    }
+    return value;
+  }
+
+  private read(position: number, length: number): Buffer {
+    const buf = Buffer.alloc(length);
+    if (length > 0) {
+      fs.readSync(this.fd, buf, 0, length, position);
+    }
+    return buf;
+  }
+}
+
+const HEADER_FIELDS: Array<keyof Header> = ['recordCount', 'stringCount', 'fileCount', 'categoryCount', 'dirCount',
+  'stringOffsets', 'stringData', 'records', 'files', 'categories', 'postings', 'dirs', 'fingerprints'];
+
+function writeHeader(buf: Buffer, header: Header): void {
+  buf.writeUInt32LE(MAGIC, 0);
+  buf.writeUInt32LE(VERSION, 4);
+  HEADER_FIELDS.forEach((field, i) => buf.writeUInt32LE(header[field], 8 + 4 * i));
+}
+
+function readHeader(buf: Buffer): Header {
+  const header = {} as Header;
+  HEADER_FIELDS.forEach((field, i) => { header[field] = buf.readUInt32LE(8 + 4 * i); });
+  return header;
+}
+
+/**
+ * 按 UTF-16 码元比较（与二分查找保持一致，不使用 localeCompare）
+ */
+function compare(a: string, b: string): number {
+  return a < b ? -1 : a > b ? 1 : 0;
+}
+
+/**
+ * 第一个使 before(i) 为 false 的下标
+ */
+function lowerBound(n: number, before: (i: number) => boolean): number {
+  let lo = 0;
+  let hi = n;
+  while (lo < hi) {
+    const mid = (lo + hi) >>> 1;
+    if (before(mid)) lo = mid + 1; else hi = mid;
+  }
+  return lo;
+}
+
+function normalize(p: string): string {
+  return p.split(path.sep).join('/').replace(/^\.(\/|$)/, '').replace(/\/+$/, '');
+}
+
+function align4(n: number): number {
+  return Math.ceil(n / 4) * 4;
+}
@@ -0,0 +1,147 @@
+import * as os from 'os';
+import * as path from 'path';
+import { AnalysisEngine, IssueRecord } from './engine';
+import { GitBlobReader, RevisionBlob, listRevisionBlobs, localIncludePaths } from './git_source';
+import { ResultCache } from './result_cache';
+import { summarizeSymbols } from './symbol_index';
+import { WorkerPool } from './worker_pool';
+
+export interface RevisionScanOptions {
+  extensions?: string[];    // 默认 ['.c']
+  pathPrefix?: string;      // 只扫描该仓库相对目录下的文件
+  jobs?: number;            // 并行工作线程数，默认 CPU 核数
+  cache?: ResultCache;
+}
+
+export interface RevisionScanStats {
+  blobs: number;
+  cached: number;           // 命中缓存、未读取内容的 blob 数
+}
+
+/**
+ * 直接从 git 对象库扫描某个提交（不检出）
+ * git ls-tree 列出 blob，命中按 blob ID 缓存的结果时不读取内容；
+ * 其余 blob 经同一个 git cat-file --batch 进程读出，交给分析引擎（工作线程池）分析并写回缓存
+ * #include "..." 的本地头文件同样取该提交中的版本；缓存条目记录所用头文件的 blob ID，头文件变化后条目不再命中
+ * 问题记录中的文件路径为 repoDir 下的对应路径
+ */
+export async function* scanRevision(repoDir: string, rev: string, options: RevisionScanOptions = {},
+                                    stats: RevisionScanStats = { blobs: 0, cached: 0 }): AsyncIterable<IssueRecord> {
+  const cache = options.cache || new ResultCache();
+  const prefix = options.pathPrefix ? `${options.pathPrefix.replace(/\/+$/, '')}/` : '';
+  const extensions = options.extensions || ['.c'];
+  const tree = await listRevisionBlobs(repoDir, rev, ['.h', ...extensions]);
+  const headerBlobs = new Map(tree.map(blob => [blob.path, blob.blob]));
+  const blobs = tree.filter(blob => blob.path.startsWith(prefix) && extensions.some(ext => blob.path.endsWith(ext)));
+  stats.blobs += blobs.length;
+
+  const misses: RevisionBlob[] = [];
+  for (const blob of blobs) {
+    const cached = cache.get(blob.blob, path.join(repoDir, blob.path), headerBlobs);
+    if (cached) {
+      stats.cached++;
+      yield* cached;
+    } else {
+      misses.push(blob);
+    }
+  }
+  if (misses.length === 0) return;
+
+  const jobs = Math.max(1, options.jobs || os.cpus().length);
+  const analyzer = new BlobAnalyzer(repoDir, cache, jobs > 1 && misses.length > 1 ? jobs : 1, headerBlobs);
+
+  const pending = new Map<number, Promise<{ index: number; issues: IssueRecord[] }>>();
+  let next = 0;
+  try {
+    while (next < misses.length || pending.size > 0) {
+      while (next < misses.length && pending.size < jobs * 2) {
+        const index = next++;
+        pending.set(index, analyzer.analyze(misses[index])
+          .catch((error): IssueRecord[] => {
+            console.error(`分析 ${rev}:${misses[index].path} 时发生错误:`, error.message);
+            return [];
+          })
+          .then(issues => ({ index, issues })));
+      }
+      const done = await Promise.race(pending.values());
+      pending.delete(done.index);
+      yield* done.issues;
+    }
+  } finally {
+    await analyzer.close();
+  }
+}
+
+/**
+ * 分析未命中缓存的 blob：经 git cat-file --batch 读出内容（或直接给出内存中的内容），交给分析引擎（jobs > 1 时为工作线程池）分析并写回缓存
+ * 给出 headerBlobs（提交中的路径 -> blob ID）时，本地头文件也从对象库读取，并把所用头文件的 blob ID 记入缓存条目
+ * 读取进程和线程池在第一次用到时才创建
+ */
+export class BlobAnalyzer {
+  private repoDir: string;
+  private cache: ResultCache;
+  private jobs: number;
+  private headerBlobs: Map<string, string> | null;
+  private reader: GitBlobReader | null = null;
+  private pool: WorkerPool<{ file: string; source: string; headers?: { [file: string]: string } }, IssueRecord[]> | null = null;
+  private engine: AnalysisEngine | null = null;
+  analyzed = 0;
+
+  constructor(repoDir: string, cache: ResultCache, jobs: number, headerBlobs?: Map<string, string>) {
+    this.repoDir = repoDir;
+    this.cache = cache;
+    this.jobs = jobs;
+    this.headerBlobs = headerBlobs || null;
+  }
+
+  async analyze(blob: RevisionBlob): Promise<IssueRecord[]> {
+    if (!this.reader) {
+      this.reader = new GitBlobReader(this.repoDir);
+    }
+    const content = await this.reader.read(blob.blob);
+    if (!content) return [];
+    const source = content.toString('utf8');
+    if (!this.headerBlobs) {
+      return this.analyzeContent(path.join(this.repoDir, blob.path), source, blob.blob);
+    }
+
+    const headers: { [file: string]: string } = {};
+    const used: { [path: string]: string } = {};
+    for (const header of localIncludePaths(blob.path, source)) {
+      const id = this.headerBlobs.get(header) || '';
+      used[header] = id;
+      const headerContent = id ? await this.reader.read(id) : null;
+      if (headerContent) headers[path.resolve(this.repoDir, header)] = headerContent.toString('utf8');
+    }
+    return this.analyzeContent(path.join(this.repoDir, blob.path), source, blob.blob, { headers, used });
+  }
+
+  /**
+   * 分析已在内存中的内容（例如从归档中读出的文件），结果按 contentHash 写入缓存
+   */
+  async analyzeContent(file: string, source: string, contentHash: string,
+                       revisionHeaders?: { headers: { [file: string]: string }; used: { [path: string]: string } }): Promise<IssueRecord[]> {
+    const headers = revisionHeaders ? revisionHeaders.headers : undefined;
+    let issues: IssueRecord[];
+    if (this.jobs > 1) {
+      if (!this.pool) {
+        this.pool = new WorkerPool<{ file: string; source: string; headers?: { [file: string]: string } }, IssueRecord[]>(
+          path.join(__dirname, 'scan_worker.js'), this.jobs);
+      }
+      issues = await this.pool.run({ file, source, headers });
+    } else {
+      if (!this.engine) {
+        this.engine = new AnalysisEngine();
+      }
+      issues = await this.engine.analyzeSource(file, source, headers);
+    }
+    this.cache.set(contentHash, issues, summarizeSymbols(source), revisionHeaders ? revisionHeaders.used : undefined);
+    this.analyzed++;
+    return issues;
+  }
+
+  async close(): Promise<void> {
+    if (this.reader) this.reader.close();
+    if (this.pool) await this.pool.close();
+  }
+}
@@ -0,0 +1,279 @@
+import * as child_process from 'child_process';
+import * as crypto from 'crypto';
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { Issue } from '../interfaces/types';
+import { execFileAsync, which } from './clang';
+import { userCacheDir } from './result_cache';
+
+export interface SanitizerReport {
+  sanitizer: 'asan' | 'lsan' | 'ubsan' | 'msan';
+  kind: string;      // 例如 heap-use-after-free、SEGV、use-of-uninitialized-value、runtime error 描述
+  file: string;
+  line: number;
+}
+
+export interface ConfirmOptions {
+  harness?: string;  // 没有 main 的翻译单元与之链接的驱动程序，默认使用同目录 main.c
+  timeoutMs?: number;
+  jobs?: number;
+  cacheDir?: string;
+}
+
+interface BuildVariant {
+  name: 'asan' | 'msan';
+  compiler: string;
+  flags: string[];
+}
+
+interface RunResult {
+  status: 'ok' | 'build-failed';
+  reports: SanitizerReport[];
+  detail?: string;
+}
+
+const COMMON_FLAGS = ['-g', '-O1', '-fno-omit-frame-pointer', '-w'];
+
+/**
+ * 运行时确认：用本机 gcc/clang 以 -fsanitize=address,undefined（clang 支持时另加 MSan）编译被报告的翻译单元，
+ * 在临时目录中运行，并依据 sanitizer 报告把静态发现标记为 confirmed / unconfirmed
+ * 构建和运行并行执行，结果按编译器、选项和源码内容哈希缓存
+ */
+export async function confirmFindings(issues: Issue[], options: ConfirmOptions = {}): Promise<Issue[]> {
+  const variants = detectVariants();
+  if (variants.length === 0) {
+    console.warn('未找到可用的 gcc/clang，跳过运行时确认');
+    return issues.map((issue): Issue => ({ ...issue, confirmation: 'not-run' }));
+  }
+
+  const cacheDir = options.cacheDir || userCacheDir('cscan-confirm-cache');
+  fs.mkdirSync(cacheDir, { recursive: true, mode: 0o700 });
+
+  const units = Array.from(new Set(issues.map(issue => issue.file)));
+  const jobs: Array<{ unit: string; variant: BuildVariant }> = [];
+  for (const unit of units) {
+    for (const variant of variants) {
+      jobs.push({ unit, variant });
+    }
+  }
+
+  const reportsByUnit = new Map<string, SanitizerReport[]>();
+  const ranUnits = new Set<string>();
+  await runWithConcurrency(jobs, options.jobs || os.cpus().length, async (job) => {
+    const result = await buildAndRun(job.unit, job.variant, cacheDir, options);
+    if (result.status === 'build-failed') {
+      return;
+    }
+    ranUnits.add(job.unit);
+    const list = reportsByUnit.get(job.unit) || [];
+    list.push(...result.reports);
+    reportsByUnit.set(job.unit, list);
+  });
+
+  return issues.map((issue): Issue => {
+    if (!ranUnits.has(issue.file)) {
+      return { ...issue, confirmation: 'not-run' };
+    }
+    const reports = reportsByUnit.get(issue.file) || [];
+    const confirmed = reports.some(report =>
+      samePath(report.file, issue.file) && report.line === issue.line && matchesCategory(report, issue.category));
+    return { ...issue, confirmation: confirmed ? 'confirmed' : 'unconfirmed' };
+  });
+}
+
+/**
+ * 按并发上限执行异步任务
+ */
+export async function runWithConcurrency<T>(items: T[], limit: number, worker: (item: T) => Promise<void>): Promise<void> {
+  let next = 0;
+  const runners: Promise<void>[] = [];
+  for (let i = 0; i < Math.max(1, Math.min(limit, items.length)); i++) {
+    runners.push((async () => {
+      while (next < items.length) {
+        const item = items[next++];
+        await worker(item);
+      }
+    })());
+  }
+  await Promise.all(runners);
+}
+
+/**
+ * 可用的构建变体：ASan+UBSan（gcc 或 clang），以及 clang 支持时的 MSan（不能与 ASan 同时启用）
+ */
+function detectVariants(): BuildVariant[] {
+  const variants: BuildVariant[] = [];
+  const clang = which('clang');
+  const gcc = which('gcc');
+  const cc = clang || gcc;
+  if (!cc) return variants;
+
+  variants.push({ name: 'asan', compiler: cc, flags: [...COMMON_FLAGS, '-fsanitize=address,undefined'] });
+
+  if (clang && process.platform === 'linux' && probeFlags(clang, ['-fsanitize=memory'])) {
+    variants.push({ name: 'msan', compiler: clang, flags: [...COMMON_FLAGS, '-fsanitize=memory', '-fsanitize-memory-track-origins'] });
+  }
+  return variants;
+}
+
+function probeFlags(compiler: string, flags: string[]): boolean {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'cscan-probe-'));
+  try {
+    const src = path.join(dir, 'probe.c');
+    fs.writeFileSync(src, 'int main(void) { return 0; }\n', 'utf8');
+    child_process.execFileSync(compiler, [...flags, '-o', path.join(dir, 'probe'), src], { stdio: 'ignore' });
+    return true;
+  } catch {
+    return false;
+  } finally {
+    fs.rmSync(dir, { recursive: true, force: true });
+  }
+}
+
+/**
+ * 构建并运行一个翻译单元；运行报告按编译器、选项、超时和源码内容哈希缓存
+ * 可执行文件构建在每次新建的私有临时目录中并在其中运行，用完即删，不经过共享的缓存目录
+ */
+async function buildAndRun(unit: string, variant: BuildVariant, cacheDir: string, options: ConfirmOptions): Promise<RunResult> {
+  const sources = translationUnitSources(unit, options.harness);
+  const hash = crypto.createHash('sha256');
+  const timeoutMs = options.timeoutMs || 10000;
+  hash.update(`${variant.compiler}\0${variant.flags.join(' ')}\0${timeoutMs}\0`);
+  for (const source of sources) {
+    hash.update(source);
+    hash.update('\0');
+    hash.update(fs.readFileSync(source));
+  }
+  for (const header of localHeaders(path.dirname(unit))) {
+    hash.update(fs.readFileSync(header));
+  }
+  const key = hash.digest('hex');
+  const resultFile = path.join(cacheDir, `${key}.json`);
+
+  if (fs.existsSync(resultFile)) {
+    try {
+      return JSON.parse(fs.readFileSync(resultFile, 'utf8')) as RunResult;
+    } catch {
+      // 缓存损坏时重新构建
+    }
+  }
+
+  let result: RunResult;
+  // mkdtemp 创建的目录只有当前用户可访问；被测程序也在这里运行，标准输入关闭，避免读写工作区
+  const sandbox = fs.mkdtempSync(path.join(os.tmpdir(), 'cscan-run-'));
+  try {
+    const binary = path.join(sandbox, `unit${process.platform === 'win32' ? '.exe' : ''}`);
+    const build = await execFileAsync(variant.compiler,
+      [...variant.flags, '-I', path.dirname(unit), '-o', binary, ...sources, '-lm', '-lpthread'],
+      { cwd: path.dirname(unit), timeout: 120000 });
+    if (build.code !== 0) {
+      result = { status: 'build-failed', reports: [], detail: build.stderr.slice(0, 2000) };
+    } else {
+      const run = await execFileAsync(binary, [], {
+        cwd: sandbox,
+        timeout: timeoutMs,
+        env: {
+          PATH: process.env.PATH || '',
+          HOME: sandbox,
+          TMPDIR: sandbox,
+          ASAN_OPTIONS: 'detect_leaks=1:halt_on_error=0:color=never',
+          UBSAN_OPTIONS: 'print_stacktrace=1:color=never',
+          MSAN_OPTIONS: 'color=never'
+        }
+      });
+      result = { status: 'ok', reports: parseSanitizerOutput(run.stderr, sources) };
+    }
+  } finally {
+    fs.rmSync(sandbox, { recursive: true, force: true });
+  }
+
+  fs.writeFileSync(resultFile, JSON.stringify(result), 'utf8');
+  return result;
+}
+
+/**
+ * 需要编译的源文件：自带 main 的翻译单元单独编译，否则与驱动程序（默认同目录 main.c）一起编译
+ */
+function translationUnitSources(unit: string, harness?: string): string[] {
+  const code = fs.readFileSync(unit, 'utf8');
+  if (/\bmain\s*\(/.test(code)) {
+    return [unit];
+  }
+  const driver = harness ? path.resolve(harness) : path.join(path.dirname(unit), 'main.c');
+  return fs.existsSync(driver) && !samePath(driver, unit) ? [unit, driver] : [unit];
+}
+
+function localHeaders(dir: string): string[] {
+  return fs.readdirSync(dir).filter(f => f.endsWith('.h')).sort().map(f => path.join(dir, f));
+}
+
+/**
+ * 解析 sanitizer 输出，取每个报告中第一个位于被测源文件内的栈帧位置
+ */
+export function parseSanitizerOutput(stderr: string, sources: string[]): SanitizerReport[] {
+  const reports: SanitizerReport[] = [];
+  const lines = stderr.split(/\r?\n/);
+  let current: { sanitizer: SanitizerReport['sanitizer']; kind: string } | null = null;
+
+  const isSource = (file: string) => sources.some(source => samePath(source, file) || path.basename(source) === path.basename(file));
+
+  for (const line of lines) {
+    // UBSan: file.c:12:5: runtime error: ...
+    const ub = line.match(/^(.*?):(\d+):(\d+): runtime error: (.*)$/);
+    if (ub) {
+      if (isSource(ub[1])) {
+        reports.push({ sanitizer: 'ubsan', kind: ub[4].trim(), file: ub[1], line: parseInt(ub[2], 10) });
+      }
+      continue;
+    }
+
+    const asan = line.match(/ERROR: AddressSanitizer: ([\w-]+)/);
+    if (asan) {
+      current = { sanitizer: 'asan', kind: asan[1] };
+      continue;
+    }
+    if (/ERROR: LeakSanitizer/.test(line) || /^(Direct|Indirect) leak of/.test(line)) {
+      current = { sanitizer: 'lsan', kind: 'memory-leak' };
+      continue;
+    }
+    const msan = line.match(/WARNING: MemorySanitizer: ([\w-]+)/);
+    if (msan) {
+      current = { sanitizer: 'msan', kind: msan[1] };
+      continue;
+    }
+
+    // 栈帧: #1 0x55d0 in main /path/file.c:12:5
+    const frame = line.match(/^\s*#\d+\s+0x[0-9a-f]+\s+in\s+\S+\s+(.*?):(\d+)(?::\d+)?\s*$/);
+    if (frame && current && isSource(frame[1])) {
+      reports.push({ sanitizer: current.sanitizer, kind: current.kind, file: frame[1], line: parseInt(frame[2], 10) });
+      // 每个报告（每条泄漏）只取一个位置；下一条 "Direct leak of" 会重新开始
+      current = null;
+    }
+  }
+
+  return reports;
+}
+
+/**
+ * 静态类别与 sanitizer 报告的对应关系
+ */
+function matchesCategory(report: SanitizerReport, category: string): boolean {
+  switch (category) {
+    case 'MemoryLeak':
+      return report.sanitizer === 'lsan';
+    case 'NullPointer':
+      return report.sanitizer === 'asan' || (report.sanitizer === 'ubsan' && /null pointer|misaligned/.test(report.kind));
+    case 'Uninitialized':
+      return report.sanitizer === 'msan' || (report.sanitizer === 'ubsan' && /not a valid value/.test(report.kind));
+    case 'NumericRange':
+      return report.sanitizer === 'ubsan' && /overflow|not representable|out of range/.test(report.kind);
+    default:
+      return false;
+  }
+}
+
+function samePath(a: string, b: string): boolean {
+  return path.resolve(a) === path.resolve(b);
+}
+
@@ -0,0 +1,19 @@
+import * as fs from 'fs';
+import { parentPort } from 'worker_threads';
+import { AnalysisEngine } from './engine';
+
+/**
+ * 扫描工作线程：每个线程持有一个分析引擎，按请求分析单个文件
+ */
+const engine = new AnalysisEngine();
+
+parentPort!.on('message', async (message: { id: number; request: { file: string; source?: string; headers?: { [file: string]: string } } }) => {
+  try {
+    // 请求可以直接携带源码（例如从 git 对象库读出的内容），否则从磁盘读取
+    const sourceCode = message.request.source !== undefined ? message.request.source : fs.readFileSync(message.request.file, 'utf8');
+    const result = await engine.analyzeSource(message.request.file, sourceCode, message.request.headers);
+    parentPort!.postMessage({ id: message.id, result });
+  } catch (error: any) {
+    parentPort!.postMessage({ id: message.id, error: String(error && error.message || error) });
+  }
+});
@@ -0,0 +1,120 @@
+import * as child_process from 'child_process';
+import * as path from 'path';
+import { GitBlobReader, localIncludePaths } from './git_source';
+
+// 空树对象：仓库还没有任何提交时与它比较
+const EMPTY_TREE = '4b825dc642cb6eb9a060e54bf8d69288fbee4904';
+
+export interface StagedFile {
+  path: string;                     // 仓库内相对路径
+  source: string;                   // 暂存区（index）中的内容
+  ranges: Array<[number, number]>;  // 暂存的新增/修改行范围（新文件中的行号，闭区间）
+  headers: { [file: string]: string };  // #include "..." 的本地头文件在暂存区中的内容（绝对路径 -> 内容，不在暂存区的不列出）
+}
+
+/**
+ * 读取暂存区中新增或修改的文件（pre-commit 使用：分析的是即将提交的内容而不是工作区）
+ * git diff-index 给出 index 中的 blob ID，git diff --cached -U0 给出暂存的行范围，
+ * 内容由同一个 git cat-file --batch 进程读入内存，不写临时文件；本地头文件同样经它读取暂存区中的版本（:<路径>）
+ */
+export async function readStagedFiles(repoDir: string, extensions: string[]): Promise<StagedFile[]> {
+  const head = await git(repoDir, ['rev-parse', '--verify', '--quiet', 'HEAD']).then(out => out.trim(), () => EMPTY_TREE);
+
+  const [raw, patch] = await Promise.all([
+    git(repoDir, ['diff-index', '--cached', '-z', '--no-renames', '--diff-filter=AM', head]),
+    git(repoDir, ['-c', 'core.quotePath=false', 'diff', '--cached', '-U0', '--no-color', '--no-ext-diff', '--no-renames',
+      '--diff-filter=AM', head])
+  ]);
+
+  // :<旧模式> <新模式> <旧ID> <新ID> <状态>\0<路径>\0
+  const blobs: Array<{ path: string; blob: string }> = [];
+  const tokens = raw.split('\0');
+  for (let i = 0; i + 1 < tokens.length; i += 2) {
+    const [, newMode, , newBlob] = tokens[i].slice(1).split(' ');
+    const file = tokens[i + 1];
+    if (newMode && newMode.startsWith('100') && extensions.some(ext => file.endsWith(ext))) {
+      blobs.push({ path: file, blob: newBlob });
+    }
+  }
+  if (blobs.length === 0) return [];
+
+  const ranges = parseHunks(patch);
+  const reader = new GitBlobReader(repoDir);
+  try {
+    const contents = await Promise.all(blobs.map(entry => reader.read(entry.blob)));
+    const sources = contents.map(content => content ? content.toString('utf8') : '');
+
+    // 先发出全部头文件读取请求（多个文件引用同一头文件时只读一次），再逐个取结果
+    const includes = blobs.map((entry, i) => localIncludePaths(entry.path, sources[i]));
+    const headerReads = new Map<string, Promise<Buffer | null>>();
+    for (const header of includes.flat()) {
+      if (!headerReads.has(header)) headerReads.set(header, reader.read(`:${header}`));
+    }
+    const files: StagedFile[] = [];
+    for (let i = 0; i < blobs.length; i++) {
+      const headers: { [file: string]: string } = {};
+      for (const header of includes[i]) {
+        const content = await headerReads.get(header)!;
+        if (content) headers[path.resolve(repoDir, header)] = content.toString('utf8');
+      }
+      files.push({ path: blobs[i].path, source: sources[i], ranges: ranges.get(blobs[i].path) || [], headers });
+    }
+    return files;
+  } finally {
+    reader.close();
+  }
+}
+
+/**
+ * 行号是否落在暂存的行范围内
+ */
+export function inStagedRanges(line: number, ranges: Array<[number, number]>): boolean {
+  return ranges.some(([from, to]) => line >= from && line <= to);
+}
+
+/**
+ * 从 -U0 的补丁中取出每个文件新增/修改的行范围（@@ -a,b +c,d @@，d 省略时为 1，为 0 时只有删除）
+ */
+function parseHunks(patch: string): Map<string, Array<[number, number]>> {
+  const result = new Map<string, Array<[number, number]>>();
+  let current: Array<[number, number]> | null = null;
+  for (const line of patch.split('\n')) {
+    if (line.startsWith('+++ ')) {
+      const target = unquotePath(line.slice(4));
+      current = target.startsWith('b/') ? [] : null;
+      if (current) result.set(target.slice(2), current);
+      continue;
+    }
+    const hunk = current && line.match(/^@@ -\d+(?:,\d+)? \+(\d+)(?:,(\d+))? @@/);
+    if (hunk) {
+      const start = parseInt(hunk[1], 10);
+      const count = hunk[2] !== undefined ? parseInt(hunk[2], 10) : 1;
+      if (count > 0) current!.push([start, start + count - 1]);
+    }
+  }
+  return result;
+}
+
+/**
+ * 含特殊字符的路径会被 git 加上 C 风格的引号
+ */
+function unquotePath(text: string): string {
+  if (!text.startsWith('"')) return text;
+  try {
+    return JSON.parse(text);
+  } catch {
+    return text.slice(1, -1);
+  }
+}
+
+function git(repoDir: string, args: string[]): Promise<string> {
+  return new Promise((resolve, reject) => {
+    child_process.execFile('git', args, { cwd: repoDir, maxBuffer: 256 * 1024 * 1024, encoding: 'utf8' }, (error, stdout) => {
+      if (error) {
+        reject(new Error(`git ${args.join(' ')} 失败: ${error.message}`));
+        return;
+      }
+      resolve(String(stdout));
+    });
+  });
+}
@@ -0,0 +1,328 @@
+import { ASTNode } from './ast_parser';
+
+export interface FieldLayout {
+  name: string;
+  type: string;
+  offset: number;
+  size: number;
+  align: number;
+  line: number;     // 从 1 开始
+}
+
+export interface StructLayout {
+  name: string;
+  file: string;
+  line: number;     // 从 1 开始
+  fields: FieldLayout[];
+  size: number;
+  align: number;
+  exact: boolean;   // 含未知类型或非常量数组长度时为 false
+}
+
+/**
+ * 基本类型的大小与对齐（LP64：Linux/macOS x86_64、aarch64）
+ */
+const PRIMITIVE_LAYOUTS: { [key: string]: { size: number; align: number } } = {
+  'char': { size: 1, align: 1 },
+  'bool': { size: 1, align: 1 },
+  '_Bool': { size: 1, align: 1 },
+  'short': { size: 2, align: 2 },
+  'int': { size: 4, align: 4 },
+  'long': { size: 8, align: 8 },
+  'long long': { size: 8, align: 8 },
+  'float': { size: 4, align: 4 },
+  'double': { size: 8, align: 8 },
+  'long double': { size: 16, align: 16 },
+  'int8_t': { size: 1, align: 1 },
+  'uint8_t': { size: 1, align: 1 },
+  'int16_t': { size: 2, align: 2 },
+  'uint16_t': { size: 2, align: 2 },
+  'int32_t': { size: 4, align: 4 },
+  'uint32_t': { size: 4, align: 4 },
+  'int64_t': { size: 8, align: 8 },
+  'uint64_t': { size: 8, align: 8 },
+  'size_t': { size: 8, align: 8 },
+  'ssize_t': { size: 8, align: 8 },
+  'ptrdiff_t': { size: 8, align: 8 },
+  'intptr_t': { size: 8, align: 8 },
+  'uintptr_t': { size: 8, align: 8 },
+  'off_t': { size: 8, align: 8 },
+  'time_t': { size: 8, align: 8 },
+  'pid_t': { size: 4, align: 4 },
+  'atomic_int': { size: 4, align: 4 },
+  'atomic_long': { size: 8, align: 8 },
+  'atomic_bool': { size: 1, align: 1 },
+  'pthread_t': { size: 8, align: 8 },
+  'pthread_mutex_t': { size: 40, align: 8 },
+  'pthread_cond_t': { size: 48, align: 8 },
+  'pthread_rwlock_t': { size: 56, align: 8 },
+  'pthread_spinlock_t': { size: 4, align: 4 },
+};
+
+const POINTER_LAYOUT = { size: 8, align: 8 };
+const UNKNOWN_LAYOUT = { size: 8, align: 8 };
+
+/**
+ * 结构体布局注册表
+ * 收集翻译单元（及其本地头文件）中的结构体定义，按 LP64 规则按需计算字段偏移
+ * 结构体可以按标签（'struct node'）或 typedef 名（'Node'）查询
+ */
+export class StructLayoutRegistry {
+  private definitions = new Map<string, { file: string; node: ASTNode }>();
+  private typedefs = new Map<string, string>();
+  private layouts = new Map<string, StructLayout | null>();
+
+  /**
+   * 收集一个翻译单元中的结构体定义和 typedef
+   */
+  addTranslationUnit(file: string, root: ASTNode): void {
+    this.layouts.clear();
+
+    this.traverseNode(root, (node) => {
+      if (node.type === 'struct_specifier' && this.findChildByType(node, 'field_declaration_list')) {
+        const tag = this.findChildByType(node, 'type_identifier');
+        if (tag) {
+          this.definitions.set(`struct ${tag.text}`, { file, node });
+        }
+      } else if (node.type === 'type_definition') {
+        const alias = node.namedChildren[node.namedChildren.length - 1];
+        const target = node.namedChildren.find(child => child.type === 'struct_specifier' || child.type === 'type_identifier' ||
+          child.type === 'primitive_type' || child.type === 'sized_type_specifier');
+        if (!alias || alias.type !== 'type_identifier' || !target || target === alias) return;
+
+        if (target.type === 'struct_specifier') {
+          const tag = this.findChildByType(target, 'type_identifier');
+          if (this.findChildByType(target, 'field_declaration_list')) {
+            // typedef struct [tag] { ... } Alias;
+            this.definitions.set(alias.text, { file, node: target });
+            if (tag) this.typedefs.set(`struct ${tag.text}`, alias.text);
+          } else if (tag) {
+            this.typedefs.set(alias.text, `struct ${tag.text}`);
+          }
+        } else {
+          this.typedefs.set(alias.text, target.text);
+        }
+      }
+    });
+  }
+
+  /**
+   * 按类型名查询结构体布局（支持 'struct tag'、typedef 名）
+   */
+  get(typeName: string): StructLayout | undefined {
+    const name = this.canonicalName(typeName);
+    if (!name) return undefined;
+
+    if (!this.layouts.has(name)) {
+      // 先占位，防止自引用结构体（通过指针以外的方式）无限递归
+      this.layouts.set(name, null);
+      const definition = this.definitions.get(name)!;
+      this.layouts.set(name, this.computeLayout(name, definition.file, definition.node));
+    }
+    return this.layouts.get(name) || undefined;
+  }
+
+  /**
+   * 解析 typedef 链，返回有定义的结构体名
+   */
+  private canonicalName(typeName: string): string | null {
+    let name = typeName.trim().replace(/\s+/g, ' ');
+    const seen = new Set<string>();
+    while (!this.definitions.has(name)) {
+      if (seen.has(name)) return null;
+      seen.add(name);
+      const next = this.typedefs.get(name);
+      if (!next) return null;
+      name = next;
+    }
+    return name;
+  }
+
+  /**
+   * 计算结构体布局：字段按自身对齐放置，结构体大小按最大对齐补齐
+   */
+  private computeLayout(name: string, file: string, structNode: ASTNode): StructLayout {
+    const body = this.findChildByType(structNode, 'field_declaration_list')!;
+    const fields: FieldLayout[] = [];
+    let offset = 0;
+    let maxAlign = 1;
+    let exact = true;
+
+    for (const decl of body.namedChildren) {
+      if (decl.type !== 'field_declaration') continue;
+
+      const typeNode = decl.namedChildren.find(child => child.type === 'primitive_type' || child.type === 'type_identifier' ||
+        child.type === 'sized_type_specifier' || child.type === 'struct_specifier' || child.type === 'union_specifier' ||
+        child.type === 'enum_specifier');
+      if (!typeNode) continue;
+      const explicitAlign = this.explicitAlignment(decl.text);
+
+      for (const declarator of decl.namedChildren) {
+        if (declarator === typeNode || !this.isFieldDeclarator(declarator)) continue;
+
+        const fieldName = this.declaratorName(declarator);
+        if (!fieldName) continue;
+
+        const layout = this.baseLayout(typeNode);
+        if (!layout.known) exact = false;
+        const shape = this.declaratorShape(declarator);
+        let size = shape.pointer ? POINTER_LAYOUT.size : layout.size;
+        let align = shape.pointer ? POINTER_LAYOUT.align : layout.align;
+
+        for (const length of shape.lengths) {
+          if (length === null) {
+            exact = false;
+          } else {
+            size *= length;
+          }
+        }
+
+        if (explicitAlign) {
+          align = Math.max(align, explicitAlign);
+        }
+
+        offset = this.alignUp(offset, align);
+        fields.push({
+          name: fieldName,
+          type: typeNode.text,
+          offset,
+          size,
+          align,
+          line: declarator.startPosition.row + 1
+        });
+        offset += size;
+        maxAlign = Math.max(maxAlign, align);
+      }
+    }
+
+    return {
+      name,
+      file,
+      line: structNode.startPosition.row + 1,
+      fields,
+      size: this.alignUp(offset, maxAlign),
+      align: maxAlign,
+      exact
+    };
+  }
+
+  /**
+   * 字段基础类型的大小与对齐
+   */
+  private baseLayout(typeNode: ASTNode): { size: number; align: number; known: boolean } {
+    if (typeNode.type === 'enum_specifier') {
+      return { size: 4, align: 4, known: true };
+    }
+    if (typeNode.type === 'struct_specifier' || typeNode.type === 'union_specifier') {
+      const inlineBody = this.findChildByType(typeNode, 'field_declaration_list');
+      if (inlineBody) {
+        const nested = this.computeLayout(typeNode.text, '', typeNode);
+        if (typeNode.type === 'union_specifier') {
+          const size = Math.max(0, ...nested.fields.map(f => f.size));
+          return { size: this.alignUp(size, nested.align), align: nested.align, known: nested.exact };
+        }
+        return { size: nested.size, align: nested.align, known: nested.exact };
+      }
+      const tag = this.findChildByType(typeNode, 'type_identifier');
+      const nested = tag && typeNode.type === 'struct_specifier' ? this.get(`struct ${tag.text}`) : undefined;
+      return nested ? { size: nested.size, align: nested.align, known: nested.exact } : { ...UNKNOWN_LAYOUT, known: false };
+    }
+
+    // unsigned long、signed char 等：去掉符号修饰后查表，单独的 unsigned/signed 视为 int
+    const text = typeNode.text.replace(/\b(unsigned|signed|const|volatile|_Atomic)\b/g, '').replace(/\s+/g, ' ').trim() || 'int';
+    if (PRIMITIVE_LAYOUTS[text]) {
+      return { ...PRIMITIVE_LAYOUTS[text], known: true };
+    }
+    if (text === 'long int' || text === 'long long int') {
+      return { size: 8, align: 8, known: true };
+    }
+    if (text === 'short int') {
+      return { size: 2, align: 2, known: true };
+    }
+
+    const resolved = this.typedefs.get(text);
+    if (resolved && PRIMITIVE_LAYOUTS[resolved]) {
+      return { ...PRIMITIVE_LAYOUTS[resolved], known: true };
+    }
+    const nested = this.get(text);
+    if (nested) {
+      return { size: nested.size, align: nested.align, known: nested.exact };
+    }
+    return { ...UNKNOWN_LAYOUT, known: false };
+  }
+
+  /**
+   * 声明器形状：从标识符向外读，遇到第一个指针之前的各维数组长度，以及元素是否为指针
+   * int *a[4] => { lengths: [4], pointer: true }；int (*a)[4] => { lengths: [], pointer: true }
+   * 非数字字面量的数组长度记为 null
+   */
+  private declaratorShape(declarator: ASTNode): { lengths: Array<number | null>; pointer: boolean } {
+    const wrappers: ASTNode[] = [];
+    let current: ASTNode | undefined = declarator;
+    while (current) {
+      if (current.type === 'pointer_declarator' || current.type === 'array_declarator') {
+        wrappers.push(current);
+      }
+      current = current.namedChildren.find(child => child.type.endsWith('_declarator'));
+    }
+
+    const lengths: Array<number | null> = [];
+    for (const wrapper of wrappers.reverse()) {
+      if (wrapper.type === 'pointer_declarator') {
+        return { lengths, pointer: true };
+      }
+      const sizeNode = wrapper.namedChildren[1];
+      lengths.push(sizeNode && /^\d+$/.test(sizeNode.text) ? parseInt(sizeNode.text, 10) : null);
+    }
+    return { lengths, pointer: false };
+  }
+
+  private explicitAlignment(text: string): number | null {
+    const match = text.match(/aligned\s*\(\s*(\d+)\s*\)/) || text.match(/_Alignas\s*\(\s*(\d+)\s*\)/) ||
+                  text.match(/alignas\s*\(\s*(\d+)\s*\)/);
+    return match ? parseInt(match[1], 10) : null;
+  }
+
+  private isFieldDeclarator(node: ASTNode): boolean {
+    return node.type === 'field_identifier' || node.type === 'pointer_declarator' ||
+           node.type === 'array_declarator' || node.type === 'function_declarator';
+  }
+
+  private declaratorName(node: ASTNode): string | null {
+    let current: ASTNode | undefined = node;
+    while (current) {
+      if (current.type === 'field_identifier' || current.type === 'identifier') {
+        return current.text;
+      }
+      current = current.namedChildren.find(child => child.type === 'field_identifier' || child.type === 'identifier' ||
+        child.type.endsWith('_declarator'));
+    }
+    return null;
+  }
+
+  private alignUp(value: number, align: number): number {
+    return Math.ceil(value / align) * align;
+  }
+
+  /**
+   * 查找指定类型的子节点
+   */
+  private findChildByType(node: ASTNode, type: string): ASTNode | null {
+    for (const child of node.namedChildren) {
+      if (child.type === type) {
+        return child;
+      }
+    }
+    return null;
+  }
+
+  /**
+   * 遍历 AST 节点
+   */
+  private traverseNode(node: ASTNode, callback: (node: ASTNode) => void): void {
+    callback(node);
+    for (const child of node.namedChildren) {
+      this.traverseNode(child, callback);
+    }
+  }
+}
@@ -0,0 +1,278 @@
+import * as crypto from 'crypto';
+
+const BITS_PER_IDENTIFIER = 10;
+const HASH_COUNT = 7;
+
+const C_KEYWORDS = new Set([
+  'auto', 'break', 'case', 'char', 'const', 'continue', 'default', 'do', 'double', 'else', 'enum', 'extern', 'float',
+  'for', 'goto', 'if', 'inline', 'int', 'long', 'register', 'restrict', 'return', 'short', 'signed', 'sizeof', 'static',
+  'struct', 'switch', 'typedef', 'union', 'unsigned', 'void', 'volatile', 'while', '_Bool', '_Alignas', '_Alignof',
+  '_Atomic', '_Noreturn', '_Static_assert', '_Thread_local', 'define', 'include', 'ifdef', 'ifndef', 'endif', 'elif',
+  'undef', 'pragma', 'defined'
+]);
+
+/**
+ * 单个文件的标识符摘要，随分析结果一起存入内容哈希缓存
+ * refs 为所有出现过的标识符的 Bloom 过滤器；defines 为文件级定义（函数、全局变量、类型、宏、结构体标签）
+ * 到定义文本哈希的映射，定义文本变化时哈希随之变化
+ */
+export interface SymbolSummary {
+  bits: number;                       // 过滤器位数
+  hashes: number;                     // 哈希函数个数
+  refs: string;                       // 过滤器位图（base64）
+  defines: { [name: string]: string };
+}
+
+/**
+ * 词法扫描源码：跳过注释、字符串和字符字面量，收集出现的标识符以及文件作用域的定义
+ * 不依赖解析器，开销远小于一次分析
+ */
+export function scanSymbols(sourceCode: string): { referenced: Set<string>; defined: Map<string, string> } {
+  const referenced = new Set<string>();
+  const defined = new Map<string, string>();
+  const length = sourceCode.length;
+
+  let braceDepth = 0;
+  let parenDepth = 0;
+  let statementStart = 0;
+  let atLineStart = true;
+  // 当前文件级语句中的 token（只记录深度 0 的标识符和符号）
+  let tokens: Array<{ text: string; paren: number }> = [];
+  let pendingFunction: { name: string; start: number } | null = null;
+
+  const define = (name: string, text: string) => {
+    defined.set(name, definitionHash(text));
+  };
+
+  let i = 0;
+  while (i < length) {
+    const ch = sourceCode[i];
+
+    if (ch === '\n') {
+      atLineStart = true;
+      i++;
+      continue;
+    }
+    if (ch === ' ' || ch === '\t' || ch === '\r') {
+      i++;
+      continue;
+    }
+    // 预处理指令：整行（含续行）单独处理
+    if (ch === '#' && atLineStart) {
+      let end = i;
+      while (end < length && (sourceCode[end] !== '\n' || sourceCode[end - 1] === '\\')) end++;
+      const directive = sourceCode.slice(i, end);
+      const macro = directive.match(/^#\s*define\s+(\w+)/);
+      if (macro) define(macro[1], directive);
+      for (const name of directive.replace(/"(?:\\.|[^"\\])*"|<[^>]*>|\/\/.*$|\/\*[\s\S]*?\*\//g, ' ').match(/[A-Za-z_]\w*/g) || []) {
+        if (!C_KEYWORDS.has(name)) referenced.add(name);
+      }
+      i = end;
+      continue;
+    }
+    atLineStart = false;
+
+    if (ch === '/' && sourceCode[i + 1] === '/') {
+      while (i < length && sourceCode[i] !== '\n') i++;
+      continue;
+    }
+    if (ch === '/' && sourceCode[i + 1] === '*') {
+      const end = sourceCode.indexOf('*/', i + 2);
+      i = end < 0 ? length : end + 2;
+      continue;
+    }
+    // 定义文本从语句的第一个记号开始，不含前面的注释与预处理行
+    if (braceDepth === 0 && tokens.length === 0) statementStart = i;
+    if (ch === '"' || ch === '\'') {
+      i++;
+      while (i < length && sourceCode[i] !== ch && sourceCode[i] !== '\n') {
+        i += sourceCode[i] === '\\' ? 2 : 1;
+      }
+      i++;
+      continue;
+    }
+
+    if (/[A-Za-z_]/.test(ch)) {
+      let end = i + 1;
+      while (end < length && /\w/.test(sourceCode[end])) end++;
+      const name = sourceCode.slice(i, end);
+      if (!C_KEYWORDS.has(name)) referenced.add(name);
+      if (braceDepth === 0) tokens.push({ text: name, paren: parenDepth });
+      i = end;
+      continue;
+    }
+
+    if (braceDepth === 0 && ch !== '{' && ch !== '}') {
+      tokens.push({ text: ch, paren: parenDepth });
+    }
+
+    switch (ch) {
+      case '(':
+        parenDepth++;
+        break;
+      case ')':
+        parenDepth = Math.max(0, parenDepth - 1);
+        break;
+      case '{':
+        if (braceDepth === 0) {
+          const last = tokens[tokens.length - 1];
+          if (last && last.text === ')') {
+            // 函数定义：参数表之前、最外层括号外的最后一个标识符
+            const open = tokens.findIndex(token => token.text === '(' && token.paren === 0);
+            const name = open > 0 ? tokens[open - 1].text : '';
+            if (/^[A-Za-z_]\w*$/.test(name)) pendingFunction = { name, start: statementStart };
+          } else {
+            // struct/union/enum 标签
+            const tagAt = tokens.length - 2;
+            if (tagAt >= 0 && /^(struct|union|enum)$/.test(tokens[tagAt].text)) {
+              tokens.push({ text: `${tokens[tagAt].text} ${tokens[tagAt + 1].text}`, paren: -1 });
+            }
+          }
+        }
+        braceDepth++;
+        break;
+      case '}':
+        braceDepth = Math.max(0, braceDepth - 1);
+        if (braceDepth === 0 && pendingFunction) {
+          define(pendingFunction.name, sourceCode.slice(pendingFunction.start, i + 1));
+          pendingFunction = null;
+          tokens = [];
+          statementStart = i + 1;
+        } else if (braceDepth === 0) {
+          // 结构体体/初始化列表结束，之后的名字（typedef struct {...} Name;）按声明处理
+          tokens.push({ text: '}', paren: parenDepth });
+        }
+        break;
+      case ';':
+        if (braceDepth === 0 && parenDepth === 0) {
+          const text = sourceCode.slice(statementStart, i + 1);
+          for (let t = 0; t < tokens.length; t++) {
+            const token = tokens[t];
+            if (token.paren === -1) {
+              define(token.text.split(' ')[1], text);
+              continue;
+            }
+            // 文件作用域声明的名字：后面是 = ; , [ 且不在括号内（排除原型的参数）
+            const following = tokens[t + 1];
+            if (token.paren === 0 && /^[A-Za-z_]\w*$/.test(token.text) && following && /^[=;,\[]$/.test(following.text) &&
+                !(t > 0 && /^(struct|union|enum)$/.test(tokens[t - 1].text))) {
+              define(token.text, text);
+            }
+          }
+          tokens = [];
+          statementStart = i + 1;
+        }
+        break;
+    }
+    i++;
+  }
+
+  return { referenced, defined };
+}
+
+/**
+ * 由源码生成标识符摘要
+ */
+export function summarizeSymbols(sourceCode: string): SymbolSummary {
+  const { referenced, defined } = scanSymbols(sourceCode);
+  for (const name of defined.keys()) {
+    referenced.add(name);
+  }
+  const filter = BloomFilter.create(referenced.size);
+  for (const name of referenced) {
+    filter.add(name);
+  }
+  const defines: { [name: string]: string } = {};
+  for (const name of Array.from(defined.keys()).sort()) {
+    defines[name] = defined.get(name)!;
+  }
+  return { bits: filter.bits, hashes: filter.hashes, refs: filter.toBase64(), defines };
+}
+
+/**
+ * 文件是否可能提到其中任一标识符（Bloom 过滤器：无漏报，有少量误报）
+ */
+export function mayMention(summary: SymbolSummary, names: Iterable<string>): boolean {
+  const filter = BloomFilter.fromBase64(summary.bits, summary.hashes, summary.refs);
+  for (const name of names) {
+    if (filter.mightContain(name)) return true;
+  }
+  return false;
+}
+
+/**
+ * 两个版本之间新增、删除或定义文本发生变化的文件级定义
+ */
+export function changedDefinitions(before: SymbolSummary | null, after: SymbolSummary | null): string[] {
+  const previous = before ? before.defines : {};
+  const current = after ? after.defines : {};
+  const changed = new Set<string>();
+  for (const name of Object.keys(previous)) {
+    if (previous[name] !== current[name]) changed.add(name);
+  }
+  for (const name of Object.keys(current)) {
+    if (previous[name] !== current[name]) changed.add(name);
+  }
+  return Array.from(changed);
+}
+
+function definitionHash(text: string): string {
+  return crypto.createHash('sha1').update(text.replace(/\s+/g, ' ').trim()).digest('hex').slice(0, 12);
+}
+
+/**
+ * 定长位图的 Bloom 过滤器，k 个位置由两个 32 位 FNV-1a 哈希组合得到（双重哈希）
+ */
+class BloomFilter {
+  bits: number;
+  hashes: number;
+  private data: Uint8Array;
+
+  private constructor(bits: number, hashes: number, data: Uint8Array) {
+    this.bits = bits;
+    this.hashes = hashes;
+    this.data = data;
+  }
+
+  static create(expectedItems: number): BloomFilter {
+    const bits = Math.max(64, Math.ceil(expectedItems * BITS_PER_IDENTIFIER / 8) * 8);
+    return new BloomFilter(bits, HASH_COUNT, new Uint8Array(bits / 8));
+  }
+
+  static fromBase64(bits: number, hashes: number, encoded: string): BloomFilter {
+    return new BloomFilter(bits, hashes, new Uint8Array(Buffer.from(encoded, 'base64')));
+  }
+
+  add(name: string): void {
+    const [h1, h2] = hashPair(name);
+    for (let i = 0; i < this.hashes; i++) {
+      const bit = (h1 + i * h2) % this.bits;
+      this.data[bit >>> 3] |= 1 << (bit & 7);
+    }
+  }
+
+  mightContain(name: string): boolean {
+    const [h1, h2] = hashPair(name);
+    for (let i = 0; i < this.hashes; i++) {
+      const bit = (h1 + i * h2) % this.bits;
+      if ((this.data[bit >>> 3] & (1 << (bit & 7))) === 0) return false;
+    }
+    return true;
+  }
+
+  toBase64(): string {
+    return Buffer.from(this.data).toString('base64');
+  }
+}
+
+function hashPair(text: string): [number, number] {
+  let h1 = 0x811c9dc5;
+  let h2 = 0x01000193 ^ 0x5bd1e995;
+  for (let i = 0; i < text.length; i++) {
+    const c = text.charCodeAt(i);
+    h1 = Math.imul(h1 ^ c, 0x01000193) >>> 0;
+    h2 = Math.imul(h2 ^ c, 0x5bd1e995) >>> 0;
+  }
+  // 第二个哈希取奇数，保证各位置不重合
+  return [h1, (h2 | 1) >>> 0];
+}
@@ -0,0 +1,265 @@
+import * as child_process from 'child_process';
+import * as fs from 'fs';
+import * as stream from 'stream';
+import * as zlib from 'zlib';
+
+const BLOCK = 512;
+
+export interface TarEntry {
+  path: string;
+  size: number;
+  content: Buffer;
+}
+
+/**
+ * 按压缩格式打开归档的解压流；.tar.gz 使用 zlib，xz/bzip2/zstd 需要本地的解码器命令
+ */
+export function openArchiveStream(archivePath: string): AsyncIterable<Buffer> {
+  const lower = archivePath.toLowerCase();
+  if (lower.endsWith('.tar.gz') || lower.endsWith('.tgz')) {
+    // pipeline 会把读取错误传递给解压流，由迭代方收到
+    const gunzip = zlib.createGunzip();
+    stream.pipeline(fs.createReadStream(archivePath), gunzip, () => { /* 错误已由 gunzip 抛出 */ });
+    return gunzip;
+  }
+  if (lower.endsWith('.tar')) {
+    return fs.createReadStream(archivePath);
+  }
+  const decoders: Array<[string[], string]> = [
+    [['.tar.xz', '.txz'], 'xz'],
+    [['.tar.bz2', '.tbz2'], 'bzip2'],
+    [['.tar.zst', '.tzst'], 'zstd']
+  ];
+  for (const [extensions, command] of decoders) {
+    if (extensions.some(ext => lower.endsWith(ext))) {
+      return decodeWith(command, archivePath);
+    }
+  }
+  throw new Error(`不支持的归档格式: ${archivePath}`);
+}
+
+export function isArchivePath(filePath: string): boolean {
+  return /\.(tar|tar\.gz|tgz|tar\.xz|txz|tar\.bz2|tbz2|tar\.zst|tzst)$/i.test(filePath);
+}
+
+/**
+ * 用外部解码器（xz -dc 等）解压，输出按流读取
+ */
+async function* decodeWith(command: string, archivePath: string): AsyncIterable<Buffer> {
+  const decoder = child_process.spawn(command, ['-dc', archivePath], { stdio: ['ignore', 'pipe', 'pipe'] });
+  let stderr = '';
+  decoder.stderr.on('data', (chunk: Buffer) => { stderr += chunk.toString(); });
+  const exited = new Promise<number | null>((resolve, reject) => {
+    decoder.on('error', (error: NodeJS.ErrnoException) => {
+      reject(error.code === 'ENOENT' ? new Error(`解压 ${archivePath} 需要本地的 ${command} 命令`) : error);
+    });
+    decoder.on('close', resolve);
+  });
+  exited.catch(() => decoder.stdout.destroy());
+
+  yield* decoder.stdout;
+  const code = await exited;
+  if (code !== 0) {
+    throw new Error(`${command} 解压失败 (${code}): ${stderr.trim()}`);
+  }
+}
+
+/**
+ * 流式读取 tar（ustar/pax/GNU 长文件名）中的普通文件
+ * 只有 want(path, size) 为真的条目才把内容读入内存，其余按块跳过；任一时刻只缓存一个条目
+ */
+export async function* readTarEntries(source: AsyncIterable<Buffer>,
+                                      want: (entryPath: string, size: number) => boolean): AsyncIterable<TarEntry> {
+  const input = new ByteReader(source[Symbol.asyncIterator]());
+  let longName: string | null = null;
+  let paxPath: string | null = null;
+
+  while (true) {
+    const header = await input.read(BLOCK);
+    if (!header && input.remaining > 0) throw new Error('tar 归档被截断');
+    if (!header || isZeroBlock(header)) return;
+    verifyChecksum(header);
+
+    const type = String.fromCharCode(header[156] || 0x30);
+    const size = parseSize(header);
+    const padded = Math.ceil(size / BLOCK) * BLOCK;
+
+    if (type === 'L' || type === 'x') {
+      const data = await input.read(padded);
+      if (!data) throw new Error('tar 归档被截断');
+      const text = data.toString('utf8', 0, size);
+      if (type === 'L') {
+        longName = text.replace(/\0.*$/s, '');
+      } else {
+        paxPath = parsePaxPath(text) || paxPath;
+      }
+      continue;
+    }
+
+    let entryPath = longName || paxPath || headerName(header);
+    longName = null;
+    paxPath = null;
+    entryPath = entryPath.replace(/^\.\//, '');
+
+    // '0' 与 '\0' 为普通文件，'7' 为连续文件；其余（目录、链接、全局 pax 头等）只跳过数据
+    const regular = type === '0' || type === '\0' || type === '7';
+    if (regular && want(entryPath, size)) {
+      const data = await input.read(padded);
+      if (!data) throw new Error('tar 归档被截断');
+      yield { path: entryPath, size, content: Buffer.from(data.subarray(0, size)) };
+    } else if (!await input.skip(padded)) {
+      throw new Error('tar 归档被截断');
+    }
+  }
+}
+
+function headerName(header: Buffer): string {
+  const name = cString(header, 0, 100);
+  // ustar 在 345 处有 155 字节的路径前缀
+  if (header.toString('latin1', 257, 262) === 'ustar') {
+    const prefix = cString(header, 345, 155);
+    if (prefix) return `${prefix}/${name}`;
+  }
+  return name;
+}
+
+function cString(buffer: Buffer, offset: number, length: number): string {
+  const end = buffer.indexOf(0, offset);
+  return buffer.toString('utf8', offset, end >= 0 && end < offset + length ? end : offset + length);
+}
+
+/**
+ * 大小字段为八进制文本；超过 8GB 时 GNU 使用最高位置 1 的 base-256 编码
+ */
+function parseSize(header: Buffer): number {
+  if (header[124] & 0x80) {
+    let size = 0;
+    for (let i = 125; i < 136; i++) {
+      size = size * 256 + header[i];
+    }
+    return size;
+  }
+  const text = header.toString('latin1', 124, 136).replace(/[\0 ]+/g, '');
+  return text ? parseInt(text, 8) : 0;
+}
+
+function verifyChecksum(header: Buffer): void {
+  let sum = 0;
+  for (let i = 0; i < BLOCK; i++) {
+    sum += i >= 148 && i < 156 ? 0x20 : header[i];
+  }
+  const stored = parseInt(header.toString('latin1', 148, 156).replace(/[\0 ]+/g, ''), 8);
+  if (stored !== sum) {
+    throw new Error('不是有效的 tar 归档（头部校验和不匹配）');
+  }
+}
+
+function isZeroBlock(block: Buffer): boolean {
+  for (let i = 0; i < block.length; i++) {
+    if (block[i] !== 0) return false;
+  }
+  return true;
+}
+
+/**
+ * pax 扩展头由 "<长度> <键>=<值>\n" 记录组成，这里只关心 path
+ */
+function parsePaxPath(text: string): string | null {
+  let offset = 0;
+  let result: string | null = null;
+  while (offset < text.length) {
+    const space = text.indexOf(' ', offset);
+    if (space < 0) break;
+    const length = parseInt(text.slice(offset, space), 10);
+    if (!(length > 0)) break;
+    const record = Buffer.from(text.slice(offset)).subarray(0, length).toString('utf8');
+    const eq = record.indexOf('=');
+    if (record.slice(record.indexOf(' ') + 1, eq) === 'path') {
+      result = record.slice(eq + 1).replace(/\n$/, '');
+    }
+    offset += record.length;
+  }
+  return result;
+}
+
+/**
+ * 在异步块序列上按字节数读取或跳过，只保留尚未消费的块
+ */
+class ByteReader {
+  private source: AsyncIterator<Buffer>;
+  private chunks: Buffer[] = [];
+  private available = 0;
+  private done = false;
+
+  constructor(source: AsyncIterator<Buffer>) {
+    this.source = source;
+  }
+
+  get remaining(): number {
+    return this.available;
+  }
+
+  /**
+   * 读取恰好 n 个字节；数据不足时返回 null
+   */
+  async read(n: number): Promise<Buffer | null> {
+    if (!await this.fill(n)) return null;
+    if (this.chunks[0].length >= n) {
+      const head = this.chunks[0];
+      const result = head.subarray(0, n);
+      this.consume(n);
+      return result;
+    }
+    const result = Buffer.allocUnsafe(n);
+    let copied = 0;
+    while (copied < n) {
+      const head = this.chunks[0];
+      const take = Math.min(head.length, n - copied);
+      head.copy(result, copied, 0, take);
+      copied += take;
+      this.consume(take);
+    }
+    return result;
+  }
+
+  /**
+   * 跳过 n 个字节，不把它们全部留在内存中
+   */
+  async skip(n: number): Promise<boolean> {
+    while (n > 0) {
+      if (this.available === 0 && !await this.fill(1)) return false;
+      const take = Math.min(n, this.available);
+      let remaining = take;
+      while (remaining > 0) {
+        const step = Math.min(remaining, this.chunks[0].length);
+        this.consume(step);
+        remaining -= step;
+      }
+      n -= take;
+    }
+    return true;
+  }
+
+  private async fill(n: number): Promise<boolean> {
+    while (this.available < n && !this.done) {
+      const next = await this.source.next();
+      if (next.done) {
+        this.done = true;
+      } else if (next.value.length > 0) {
+        this.chunks.push(next.value);
+        this.available += next.value.length;
+      }
+    }
+    return this.available >= n;
+  }
+
+  private consume(n: number): void {
+    const head = this.chunks[0];
+    if (n >= head.length) {
+      this.chunks.shift();
+    } else {
+      this.chunks[0] = head.subarray(n);
+    }
+    this.available -= n;
+  }
+}
@@ -0,0 +1,306 @@
+import * as crypto from 'crypto';
+import { ASTNode, CASTParser } from './ast_parser';
+import { CfgEdge, CfgNode, ControlFlowGraph } from './cfg';
+
+// 保留控制流图的文件数（按内容哈希）；悬停、code lens 等编辑器请求通常集中在少数几个打开的文件上
+const CACHE_SIZE = 32;
+
+export type WitnessKind = 'null' | 'uninit';
+
+export interface WitnessStep {
+  line: number;       // 1 起始行号
+  text: string;       // 该行源码（去掉首尾空白）
+  note: string;       // 这一步发生了什么
+}
+
+/**
+ * 见证路径：从变量获得问题值的位置，经过若干分支，到达报告问题的行
+ * found 为 false 时表示在控制流图上找不到这样的路径（多半是误报），steps 只含源与汇
+ */
+export interface Witness {
+  variable: string;
+  kind: WitnessKind;
+  found: boolean;
+  steps: WitnessStep[];
+  summary: string;
+}
+
+interface CachedUnit {
+  root: ASTNode;
+  graphs: Map<ASTNode, ControlFlowGraph>;
+}
+
+/**
+ * 按需重建见证路径（cscan explain、编辑器悬停）
+ * 问题本身只携带紧凑的引用（文件、行号、消息，或结果存储中的指纹）；需要解释时才解析文件，
+ * 为问题所在的函数构造控制流图，并在图上重新求一遍到达该行的数据流路径
+ * 控制流图按文件内容哈希缓存（最近使用的 CACHE_SIZE 个文件），同一文件上的连续请求不会重复解析
+ * 目前支持空指针解引用和未初始化使用两类问题
+ */
+export class WitnessExplainer {
+  private parser: CASTParser;
+  private units = new Map<string, CachedUnit>();
+
+  constructor(parser: CASTParser = new CASTParser()) {
+    this.parser = parser;
+  }
+
+  /**
+   * 解释 sourceCode 中第 finding.line 行（1 起始）上的问题；问题类别不受支持或不在函数内时返回 null
+   */
+  explain(sourceCode: string, finding: { line: number; message: string }): Witness | null {
+    const kind = witnessKind(finding.message);
+    const variableMatch = finding.message.match(/'([A-Za-z_]\w*)'/);
+    if (!kind || !variableMatch) {
+      return null;
+    }
+    const variable = variableMatch[1];
+
+    const unit = this.unit(sourceCode);
+    const functionNode = findFunction(unit.root, finding.line);
+    if (!functionNode) {
+      return null;
+    }
+    let graph = unit.graphs.get(functionNode);
+    if (!graph) {
+      graph = ControlFlowGraph.build(functionNode);
+      unit.graphs.set(functionNode, graph);
+    }
+
+    // 同一行可能有多个节点（如 if (p) *p = 1;），优先取在这一行上使用了该变量的节点
+    const candidates = graph.nodesAtLine(finding.line);
+    const sink = candidates.find(node => usesAtLine(node, variable, kind, finding.line)) || candidates[0];
+    if (!sink) {
+      return null;
+    }
+    const sourceLines = sourceCode.split('\n');
+    const sinkNote = kind === 'null' || /解引用/.test(finding.message) ? '被解引用' : '被使用';
+    const sinkStep = step(sourceLines, finding.line, `${variable} ${sinkNote}`);
+
+    const sources = graph.nodes.filter(node => node !== sink && effectOf(node, variable, kind) === 'source');
+    const path = searchPath(graph, sources, sink, variable, kind);
+    if (!path) {
+      const summary = sources.length > 0
+        ? `${variable} 在第 ${sources.map(node => node.line).join('、')} 行${sourceDescription(kind)}，` +
+          `但没有不经重新赋值或空指针检查到达第 ${finding.line} 行的路径，该问题可能是误报`
+        : `函数中没有 ${variable} ${sourceDescription(kind)}的位置，该问题可能是误报`;
+      return {
+        variable,
+        kind,
+        found: false,
+        steps: [...sources.map(node => step(sourceLines, node.line, sourceNote(variable, kind))), sinkStep],
+        summary
+      };
+    }
+
+    const steps: WitnessStep[] = [step(sourceLines, path[0].node.line, sourceNote(variable, kind))];
+    const via: string[] = [];
+    for (let i = 1; i < path.length; i++) {
+      const edge = path[i].edge;
+      const from = path[i - 1].node;
+      if (!edge || (from.kind !== 'branch' && edge.label !== 'goto')) continue;
+      const note = describeEdge(from, edge);
+      steps.push(step(sourceLines, from.line, note));
+      via.push(`第 ${from.line} 行 ${note}`);
+    }
+    steps.push(sinkStep);
+
+    const summary = `${variable} 在第 ${path[0].node.line} 行${sourceDescription(kind)}，` +
+      (via.length > 0 ? `经${via.join('，')}，` : '') +
+      `在第 ${finding.line} 行${sinkNote}`;
+    return { variable, kind, found: true, steps, summary };
+  }
+
+  private unit(sourceCode: string): CachedUnit {
+    const key = crypto.createHash('sha1').update(sourceCode).digest('hex');
+    let unit = this.units.get(key);
+    if (unit) {
+      // 重新插入，使 Map 的顺序保持为最近使用顺序
+      this.units.delete(key);
+    } else {
+      unit = { root: this.parser.parse(sourceCode), graphs: new Map() };
+      this.parser.reset();
+    }
+    this.units.set(key, unit);
+    if (this.units.size > CACHE_SIZE) {
+      this.units.delete(this.units.keys().next().value as string);
+    }
+    return unit;
+  }
+}
+
+function witnessKind(message: string): WitnessKind | null {
+  if (/可能为 NULL/.test(message)) return 'null';
+  if (/未初始化|在初始化前被使用/.test(message)) return 'uninit';
+  return null;
+}
+
+function sourceDescription(kind: WitnessKind): string {
+  return kind === 'null' ? '被设为 NULL' : '声明时未初始化';
+}
+
+function sourceNote(variable: string, kind: WitnessKind): string {
+  return `${variable} ${sourceDescription(kind)}`;
+}
+
+function step(sourceLines: string[], line: number, note: string): WitnessStep {
+  return { line, text: (sourceLines[line - 1] || '').trim(), note };
+}
+
+/**
+ * 控制流图上的广度优先搜索：从任一源节点出发，不经过重新赋值的节点和排除问题值的分支，
+ * 返回到达汇节点的最短路径（每个元素带上进入该节点的边）
+ */
+function searchPath(graph: ControlFlowGraph, sources: CfgNode[], sink: CfgNode, variable: string,
+  kind: WitnessKind): Array<{ node: CfgNode; edge: CfgEdge | null }> | null {
+  const parent = new Map<number, { from: number; edge: CfgEdge } | null>();
+  const queue: number[] = [];
+  for (const source of sources) {
+    parent.set(source.id, null);
+    queue.push(source.id);
+  }
+
+  for (let head = 0; head < queue.length; head++) {
+    const node = graph.nodes[queue[head]];
+    if (node === sink) {
+      const path: Array<{ node: CfgNode; edge: CfgEdge | null }> = [];
+      for (let id: number | undefined = node.id; id !== undefined;) {
+        const link = parent.get(id);
+        path.unshift({ node: graph.nodes[id], edge: link ? link.edge : null });
+        id = link ? link.from : undefined;
+      }
+      return path;
+    }
+    if (parent.get(node.id) !== null && effectOf(node, variable, kind) === 'kill') {
+      continue;
+    }
+    const excluded = kind === 'null' && node.kind === 'branch' ? nonNullEdges(node, variable) : [];
+    for (const edge of node.succ) {
+      if (excluded.includes(edge.label) || parent.has(edge.to)) continue;
+      parent.set(edge.to, { from: node.id, edge });
+      queue.push(edge.to);
+    }
+  }
+  return null;
+}
+
+/**
+ * 节点对变量的作用：source 使变量获得问题值，kill 使其获得正常的值
+ */
+function effectOf(node: CfgNode, variable: string, kind: WitnessKind): 'source' | 'kill' | null {
+  if (!node.ast) return null;
+  let effect: 'source' | 'kill' | null = null;
+
+  walk(node.ast, current => {
+    if (current.type === 'init_declarator' || current.type === 'assignment_expression') {
+      const left = current.namedChildren[0];
+      const isTarget = current.type === 'init_declarator'
+        ? declaredName(left) === variable
+        : !!left && left.type === 'identifier' && left.text === variable;
+      if (!isTarget) return;
+      const value = current.namedChildren[current.namedChildren.length - 1];
+      effect = kind === 'null' && value && isNullConstant(value) ? 'source' : 'kill';
+    } else if (kind === 'uninit' && current.type === 'declaration' && current === node.ast) {
+      for (const declarator of current.namedChildren) {
+        if (declarator.type !== 'init_declarator' && declaredName(declarator) === variable) {
+          effect = 'source';
+        }
+      }
+    } else if (current.type === 'pointer_expression' && current.text.replace(/\s+/g, '') === `&${variable}`) {
+      // 取地址后可能经由指针写入（scanf 等），不再跟踪
+      effect = 'kill';
+    }
+  });
+  return effect;
+}
+
+/**
+ * 分支条件排除空指针的那条边：if (p)、p != NULL 的 then 边，!p、p == NULL 的 else 边
+ */
+function nonNullEdges(node: CfgNode, variable: string): string[] {
+  if (!node.ast) return [];
+  const condition = node.ast.text.replace(/\s+/g, '').replace(/^\((.*)\)$/, '$1');
+  const name = variable.replace(/\$/g, '\\$');
+  const nullConstant = '(NULL|0|\\(void\\*\\)0)';
+  if (new RegExp(`^(${name}|${name}!=${nullConstant}|${nullConstant}!=${name})$`).test(condition)) {
+    return ['then', 'loop'];
+  }
+  if (new RegExp(`^(!${name}|${name}==${nullConstant}|${nullConstant}==${name})$`).test(condition)) {
+    return ['else', 'exit-loop'];
+  }
+  return [];
+}
+
+function describeEdge(from: CfgNode, edge: CfgEdge): string {
+  if (edge.label === 'goto') {
+    return `${from.ast ? from.ast.text.replace(/\s+/g, ' ').trim() : 'goto'} 跳转`;
+  }
+  const condition = from.ast ? from.ast.text.replace(/\s+/g, ' ').trim() : '(;;)';
+  const shown = condition.length > 40 ? condition.slice(0, 37) + '...' : condition;
+  const owner = from.owner ? from.owner.type : '';
+  switch (edge.label) {
+    case 'then':
+      return `if ${shown} 的 then 分支`;
+    case 'else':
+      return `if ${shown} 的 else 分支`;
+    case 'loop':
+      return `${owner === 'do_statement' ? 'do-while' : owner === 'for_statement' ? 'for' : 'while'} ${shown} 进入循环体`;
+    case 'exit-loop':
+      return `循环条件 ${shown} 不成立，退出循环`;
+    case 'case':
+      return `switch ${shown} 的 ${edge.caseLabel === 'default' ? 'default' : `case ${edge.caseLabel}`} 分支`;
+    default:
+      return '';
+  }
+}
+
+/**
+ * 节点在第 line 行上是否使用了变量：空指针问题要求解引用（*p、p->f、p[i]），未初始化问题只要求出现
+ */
+function usesAtLine(node: CfgNode, variable: string, kind: WitnessKind, line: number): boolean {
+  if (!node.ast) return false;
+  let uses = false;
+  walk(node.ast, current => {
+    if (current.startPosition.row + 1 !== line) return;
+    const first = current.namedChildren[0];
+    const isVariable = !!first && first.type === 'identifier' && first.text === variable;
+    if (kind === 'uninit') {
+      uses = uses || (current.type === 'identifier' && current.text === variable);
+    } else if (current.type === 'pointer_expression' && /^\*/.test(current.text.trim())) {
+      uses = uses || isVariable;
+    } else if (current.type === 'field_expression' || current.type === 'subscript_expression') {
+      uses = uses || isVariable;
+    }
+  });
+  return uses;
+}
+
+function isNullConstant(node: ASTNode): boolean {
+  return /^(NULL|0|\(\s*void\s*\*\s*\)\s*0)$/.test(node.text.trim());
+}
+
+function declaredName(declarator: ASTNode | undefined): string | null {
+  let current = declarator;
+  while (current && current.type !== 'identifier') {
+    current = current.namedChildren.find(child => child.type !== 'comment' && child.type !== 'type_qualifier');
+  }
+  return current ? current.text : null;
+}
+
+function findFunction(root: ASTNode, line: number): ASTNode | null {
+  let found: ASTNode | null = null;
+  walk(root, node => {
+    if (node.type === 'function_definition' &&
+        node.startPosition.row + 1 <= line && line <= node.endPosition.row + 1) {
+      found = node;
+    }
+  });
+  return found;
+}
+
+function walk(node: ASTNode, callback: (node: ASTNode) => void): void {
+  callback(node);
+  for (const child of node.namedChildren) {
+    walk(child, callback);
+  }
+}
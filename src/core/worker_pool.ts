@@ -0,0 +1,104 @@
+import { Worker } from 'worker_threads';
+
+interface Task<TReq, TRes> {
+  id: number;
+  request: TReq;
+  resolve: (result: TRes) => void;
+  reject: (error: Error) => void;
+}
+
+interface PoolWorker<TReq, TRes> {
+  worker: Worker;
+  task: Task<TReq, TRes> | null;
+}
+
+/**
+ * 固定大小的工作线程池
+ * 工作线程脚本接收 { id, request }，回复 { id, result } 或 { id, error }；每个线程同一时刻只处理一个任务
+ * 线程异常退出时当前任务失败，并按需补充新线程
+ */
+export class WorkerPool<TReq, TRes> {
+  private workers: PoolWorker<TReq, TRes>[] = [];
+  private queue: Task<TReq, TRes>[] = [];
+  private nextId = 0;
+  private closed = false;
+  private script: string;
+  private size: number;
+
+  constructor(script: string, size: number) {
+    this.script = script;
+    this.size = Math.max(1, size);
+  }
+
+  /**
+   * 提交任务，返回结果的 Promise
+   */
+  run(request: TReq): Promise<TRes> {
+    if (this.closed) {
+      return Promise.reject(new Error('WorkerPool is closed'));
+    }
+    return new Promise<TRes>((resolve, reject) => {
+      this.queue.push({ id: this.nextId++, request, resolve, reject });
+      this.dispatch();
+    });
+  }
+
+  /**
+   * 终止所有线程，未完成的任务以错误结束
+   */
+  async close(): Promise<void> {
+    this.closed = true;
+    const pending = [...this.queue, ...this.workers.map(w => w.task).filter((t): t is Task<TReq, TRes> => !!t)];
+    this.queue = [];
+    for (const task of pending) {
+      task.reject(new Error('WorkerPool is closed'));
+    }
+    const workers = this.workers;
+    this.workers = [];
+    await Promise.all(workers.map(w => w.worker.terminate()));
+  }
+
+  private dispatch(): void {
+    while (this.queue.length > 0) {
+      let idle = this.workers.find(w => !w.task);
+      if (!idle && this.workers.length < this.size) {
+        idle = this.spawn();
+      }
+      if (!idle) return;
+      const task = this.queue.shift()!;
+      idle.task = task;
+      idle.worker.postMessage({ id: task.id, request: task.request });
+    }
+  }
+
+  private spawn(): PoolWorker<TReq, TRes> {
+    const entry: PoolWorker<TReq, TRes> = { worker: new Worker(this.script), task: null };
+
+    entry.worker.on('message', (message: { id: number; result?: TRes; error?: string }) => {
+      const task = entry.task;
+      if (!task || task.id !== message.id) return;
+      entry.task = null;
+      if (message.error !== undefined) {
+        task.reject(new Error(message.error));
+      } else {
+        task.resolve(message.result as TRes);
+      }
+      this.dispatch();
+    });
+
+    const fail = (error: Error) => {
+      const task = entry.task;
+      entry.task = null;
+      this.workers = this.workers.filter(w => w !== entry);
+      if (task) task.reject(error);
+      if (!this.closed) this.dispatch();
+    };
+    entry.worker.on('error', fail);
+    entry.worker.on('exit', (code) => {
+      if (this.workers.includes(entry)) fail(new Error(`worker exited with code ${code}`));
+    });
+
+    this.workers.push(entry);
+    return entry;
+  }
+}
@@ -7,8 +7,8 @@ import { CASTParser, ASTNode, FunctionCall } from '../core/ast_parser';
 export class StandaloneASTAdvancedDetector {
   private parser: CASTParser;
 
-  constructor() {
-    this.parser = new CASTParser();
+  constructor(parser: CASTParser = new CASTParser()) {
+    this.parser = parser;
   }
 
   /**
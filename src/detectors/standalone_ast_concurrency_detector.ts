@@ -0,0 +1,509 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { CASTParser, ASTNode } from '../core/ast_parser';
+import { CallGraph } from '../core/call_graph';
+import { ControlFlowGraph } from '../core/cfg';
+import { HeldLocks, LockRegionTracker } from '../core/lock_regions';
+import { LoopAnalyzer } from '../core/loop_analyzer';
+import { LoopInfo } from '../interfaces/types';
+import { StructLayoutRegistry, FieldLayout } from '../core/struct_layout';
+import { blockingCallKind, pureFunctions } from '../utils/function_header_map';
+
+const CACHE_LINE_SIZE = 64;
+
+const LOOP_TYPES = new Set(['for_statement', 'while_statement', 'do_statement']);
+// 等待时会释放互斥锁的函数：循环等待条件变量是正确的写法，不算临界区内的长循环
+const CONDITION_WAIT_FUNCTIONS = new Set(['pthread_cond_wait', 'pthread_cond_timedwait', 'cnd_wait', 'cnd_timedwait']);
+const ALLOCATION_FUNCTIONS = new Set(['malloc', 'calloc', 'realloc', 'free']);
+
+interface FieldWrite {
+  entry: string;        // 线程入口函数
+  objectKey: string;    // 被写对象：全局变量名、pthread_create 的实参，或线程自己的局部对象
+  structName: string;
+  field: FieldLayout;
+  node: ASTNode;
+}
+
+/**
+ * 独立的AST并发检测器（不依赖VSCode API）
+ * 包含伪共享检测、临界区内阻塞调用检测
+ */
+export class StandaloneASTConcurrencyDetector {
+  private parser: CASTParser;
+  private headerParser: CASTParser | null = null;   // 头文件单独解析，不挤掉共享解析器记住的源文件 AST
+  private lockTracker: LockRegionTracker;
+  private loopAnalyzer: LoopAnalyzer;
+
+  constructor(parser: CASTParser = new CASTParser()) {
+    this.parser = parser;
+    this.lockTracker = new LockRegionTracker();
+    this.loopAnalyzer = new LoopAnalyzer();
+  }
+
+  /**
+   * 分析文件并返回所有问题列表
+   * headers 给出本地头文件内容（绝对路径 -> 内容）时按它查找结构体定义，不读取磁盘
+   */
+  async analyzeFile(filePath: string, sourceCode: string, headers?: { [file: string]: string }): Promise<any[]> {
+    const sourceLines = sourceCode.split(/\r?\n/);
+    const issues: any[] = [];
+
+    try {
+      const ast = this.parser.parse(sourceCode);
+
+      const callGraph = new CallGraph();
+      callGraph.addTranslationUnit(filePath, ast);
+
+      const layouts = new StructLayoutRegistry();
+      for (const header of this.localHeaders(filePath, ast, headers)) {
+        layouts.addTranslationUnit(header.file, header.ast);
+      }
+      layouts.addTranslationUnit(filePath, ast);
+
+      // 伪共享检测
+      issues.push(...this.detectFalseSharing(ast, callGraph, layouts, filePath, sourceLines));
+
+      // 临界区内阻塞调用检测
+      issues.push(...this.detectBlockingInCriticalSection(ast, filePath, sourceLines));
+
+    } catch (error) {
+      console.error('AST parsing error in concurrency detector:', error);
+    }
+
+    return issues;
+  }
+
+  /**
+   * 伪共享检测
+   * 不同线程入口（pthread_create 的第 3 个实参）经调用图可达的函数中，通过同一对象写入同一结构体的不同字段，
+   * 且两个字段落在同一个 64 字节缓存行范围内时报告
+   */
+  detectFalseSharing(ast: ASTNode, callGraph: CallGraph, layouts: StructLayoutRegistry,
+                     filePath: string, sourceLines: string[]): any[] {
+    const issues: any[] = [];
+    const writes: FieldWrite[] = [];
+
+    for (const thread of this.threadEntries(ast)) {
+      const entry = callGraph.resolve(thread.entry, filePath)[0];
+      if (!entry) continue;
+      const aliases = this.threadArgumentAliases(entry.key, callGraph);
+      for (const key of callGraph.reachableFrom(entry.key)) {
+        const func = callGraph.getFunction(key)!;
+        writes.push(...this.collectFieldWrites(func.name, func.node, ast, thread, layouts, aliases.get(key) || new Set()));
+      }
+    }
+
+    // 按 (对象, 结构体) 分组，比较不同线程写入的不同字段
+    const groups = new Map<string, FieldWrite[]>();
+    for (const write of writes) {
+      const key = `${write.objectKey}|${write.structName}`;
+      if (!groups.has(key)) groups.set(key, []);
+      groups.get(key)!.push(write);
+    }
+
+    const reported = new Set<string>();
+    for (const group of groups.values()) {
+      for (let i = 0; i < group.length; i++) {
+        for (let j = i + 1; j < group.length; j++) {
+          const a = group[i];
+          const b = group[j];
+          if (a.entry === b.entry || a.field.name === b.field.name) continue;
+          if (!this.shareCacheLine(a.field, b.field)) continue;
+
+          const [first, second] = a.field.offset <= b.field.offset ? [a, b] : [b, a];
+          const key = `${first.structName}.${first.field.name}|${second.field.name}`;
+          if (reported.has(key)) continue;
+          reported.add(key);
+
+          issues.push({
+            file: filePath,
+            line: second.node.startPosition.row + 1,
+            column: second.node.startPosition.column,
+            category: 'FalseSharing',
+            message: `结构体 '${first.structName}' 的字段 '${first.field.name}'（偏移 ${first.field.offset}，线程 ${first.entry} 写入）` +
+              `与 '${second.field.name}'（偏移 ${second.field.offset}，线程 ${second.entry} 写入）位于同一 ${CACHE_LINE_SIZE} 字节缓存行内，` +
+              `可能产生伪共享；考虑在字段间填充，或对字段使用 _Alignas(${CACHE_LINE_SIZE}) / __attribute__((aligned(${CACHE_LINE_SIZE})))`,
+            severity: 2, // Information
+            codeLine: sourceLines[second.node.startPosition.row] || ''
+          });
+        }
+      }
+    }
+
+    return issues;
+  }
+
+  /**
+   * 临界区内阻塞调用检测
+   * 在每个函数的控制流图上跟踪 pthread_mutex_lock/unlock 等成对调用界定的锁区域，
+   * 沿所有路径都持有锁的位置上报告：文件/控制台 I/O、网络调用、休眠、创建进程（按库函数头文件分类），
+   * 循环中的 malloc/free，以及次数取决于输入规模的循环；这些操作会拉长临界区，让等待同一把锁的线程一起阻塞
+   */
+  detectBlockingInCriticalSection(ast: ASTNode, filePath: string, sourceLines: string[]): any[] {
+    const issues: any[] = [];
+    const report = (node: ASTNode, held: HeldLocks, message: string, severity: number) => {
+      const [lock, line] = held.entries().next().value as [string, number];
+      issues.push({
+        file: filePath,
+        line: node.startPosition.row + 1,
+        column: node.startPosition.column,
+        category: 'LockContention',
+        message: `持有锁 '${lock}'（第 ${line} 行加锁）时${message}`,
+        severity,
+        codeLine: sourceLines[node.startPosition.row] || ''
+      });
+    };
+
+    for (const func of this.collectByTypes(ast, ['function_definition'])) {
+      if (!this.containsCall(func, name => /lock$/.test(name))) continue;
+
+      const graph = ControlFlowGraph.build(func);
+      const heldAtEntry = this.lockTracker.heldAtEntry(graph);
+      const parameters = this.parameterNames(func);
+      const reportedLoops = new Set<ASTNode>();
+
+      graph.nodes.forEach((node, id) => {
+        const held = heldAtEntry[id];
+        if (!held) return;
+
+        // 循环条件节点：循环开始时已持有锁，且次数取决于输入规模
+        if (node.kind === 'branch' && node.owner && LOOP_TYPES.has(node.owner.type) && held.size > 0 &&
+            !reportedLoops.has(node.owner)) {
+          reportedLoops.add(node.owner);
+          const loop = this.loopAnalyzer.analyze(node.owner, pureFunctions);
+          if (this.loopAnalyzer.isInputBound(loop, parameters) && !this.copiesIntoLocals(loop, func) &&
+              !this.containsCall(node.owner, name => CONDITION_WAIT_FUNCTIONS.has(name))) {
+            report(node.owner, held, `执行次数取决于输入规模的循环，临界区长度随输入增长；缩小临界区，或先复制所需数据、解锁后再遍历`, 2);
+          }
+        }
+
+        this.lockTracker.walkCalls(node, held, (call, callee, current) => {
+          if (current.size === 0) return;
+          const kind = blockingCallKind(callee);
+          if (kind) {
+            report(call, current, `调用 '${callee}'（${kind}），等待同一把锁的线程会随之阻塞；把该调用移到解锁之后`, 1);
+          } else if (ALLOCATION_FUNCTIONS.has(callee) && this.loopAnalyzer.enclosingLoop(call) &&
+                     this.isWithin(this.loopAnalyzer.enclosingLoop(call)!, func)) {
+            report(call, current, `在循环中调用 '${callee}'，分配器可能加锁或进入内核，拉长临界区；在加锁前预先分配，或解锁后再释放`, 2);
+          }
+        });
+      });
+    }
+
+    return issues.sort((a, b) => a.line - b.line);
+  }
+
+  /**
+   * 循环体是否只把数据复制到函数自己的局部数组/结构体中（copy[i] = shared[i]，可带局部下标的自增）
+   * 这正是缩短临界区的推荐写法：持锁时复制，解锁后再处理，不算临界区内的长循环
+   */
+  private copiesIntoLocals(loop: LoopInfo, func: ASTNode): boolean {
+    const statements: ASTNode[] = [];
+    const flatten = (node: ASTNode) => {
+      if (node.type === 'compound_statement') node.namedChildren.filter(child => child.type !== 'comment').forEach(flatten);
+      else statements.push(node);
+    };
+    if (!loop.body) return false;
+    flatten(loop.body);
+    if (statements.length === 0) return false;
+
+    return statements.every(statement => {
+      const assignment = statement.type === 'expression_statement' ? statement.namedChildren[0] : undefined;
+      // while 形式的复制循环自己推进局部下标
+      if (assignment && assignment.type === 'update_expression') {
+        const index = assignment.namedChildren[0];
+        return !!index && index.type === 'identifier' && this.isLocalObject(func, index.text);
+      }
+      if (!assignment || assignment.type !== 'assignment_expression') return false;
+      const target = assignment.namedChildren[0];
+      const value = assignment.namedChildren[assignment.namedChildren.length - 1];
+      // 复合赋值（total += shared[i]）是在持锁时处理数据，不是复制
+      if (!assignment.children.some(child => child.type === '=')) return false;
+      if (!target || !value || value === target || this.containsCall(value, () => true)) return false;
+      // 只接受 a[i]、a.f 形式写入局部对象本身，*p、p->f 可能写到共享数据
+      let current: ASTNode | undefined = target;
+      while (current && (current.type === 'subscript_expression' ||
+             (current.type === 'field_expression' && !current.children.some(child => child.type === '->')))) {
+        current = current.namedChildren[0];
+      }
+      return !!current && current.type === 'identifier' && this.isLocalObject(func, current.text);
+    });
+  }
+
+  /**
+   * name 是否为函数体内声明的数组或非指针对象（不含形参）
+   */
+  private isLocalObject(func: ASTNode, name: string): boolean {
+    const body = func.namedChildren.find(child => child.type === 'compound_statement');
+    if (!body) return false;
+    return this.collectByTypes(body, ['declaration']).some(decl => decl.namedChildren.some(child => {
+      let declarator: ASTNode | undefined = child.type === 'init_declarator' ? child.namedChildren[0] : child;
+      while (declarator && declarator.type === 'array_declarator') declarator = declarator.namedChildren[0];
+      return !!declarator && declarator.type === 'identifier' && declarator.text === name &&
+        !decl.children.some(c => c.type === 'storage_class_specifier' && c.text === 'static');
+    }));
+  }
+
+  /**
+   * 子树中是否调用了满足 predicate 的函数
+   */
+  private containsCall(node: ASTNode, predicate: (name: string) => boolean): boolean {
+    let found = false;
+    this.traverseAST(node, (child) => {
+      if (found || child.type !== 'call_expression') return;
+      const callee = child.namedChildren[0];
+      if (callee && callee.type === 'identifier' && predicate(callee.text)) found = true;
+    });
+    return found;
+  }
+
+  /**
+   * 函数的形参名
+   */
+  private parameterNames(func: ASTNode): string[] {
+    const names: string[] = [];
+    const declarator = func.namedChildren.find(child => child.type === 'function_declarator') ||
+      this.collectByTypes(func, ['function_declarator'])[0];
+    if (!declarator) return names;
+    for (const param of this.collectByTypes(declarator, ['parameter_declaration'])) {
+      for (const child of param.namedChildren) {
+        let current: ASTNode | undefined = child;
+        while (current && current.type !== 'identifier' && current.type.endsWith('_declarator')) {
+          current = current.namedChildren[0];
+        }
+        if (current && current.type === 'identifier') names.push(current.text);
+      }
+    }
+    return names;
+  }
+
+  /**
+   * 判断 node 是否位于 container 子树内
+   */
+  private isWithin(node: ASTNode, container: ASTNode): boolean {
+    let current: ASTNode | undefined = node;
+    while (current) {
+      if (current === container) return true;
+      current = current.parent;
+    }
+    return false;
+  }
+
+  /**
+   * 两个字段的字节范围能否落在同一缓存行内（结构体基址对齐未知，按跨度判断）
+   */
+  private shareCacheLine(a: FieldLayout, b: FieldLayout): boolean {
+    const start = Math.min(a.offset, b.offset);
+    const end = Math.max(a.offset + a.size, b.offset + b.size);
+    const disjoint = a.offset + a.size <= b.offset || b.offset + b.size <= a.offset;
+    return disjoint && end - start <= CACHE_LINE_SIZE;
+  }
+
+  /**
+   * 线程入口：pthread_create(&tid, attr, entry, arg)
+   */
+  private threadEntries(ast: ASTNode): Array<{ entry: string; arg: string }> {
+    const entries: Array<{ entry: string; arg: string }> = [];
+    for (const call of this.parser.extractFunctionCalls(ast)) {
+      if (call.name !== 'pthread_create' || call.arguments.length < 4) continue;
+      const entry = call.arguments[2].replace(/^\(\s*void\s*\*\s*\(\s*\*\s*\)\s*\(\s*void\s*\*\s*\)\s*\)/, '').replace(/^&/, '').trim();
+      if (/^[A-Za-z_]\w*$/.test(entry)) {
+        entries.push({ entry, arg: call.arguments[3].replace(/\s+/g, '') });
+      }
+    }
+    return entries;
+  }
+
+  /**
+   * 收集函数内对结构体字段的写入（赋值、复合赋值、自增自减）
+   * g.f / g->f（g 为全局变量）的对象是全局变量本身；argAliases 中的变量指向线程实参；
+   * 其余局部变量与形参的对象无法确定，按线程和函数区分，不与其他线程的写入比较
+   */
+  private collectFieldWrites(funcName: string, funcNode: ASTNode, root: ASTNode, thread: { entry: string; arg: string },
+                             layouts: StructLayoutRegistry, argAliases: Set<string>): FieldWrite[] {
+    const writes: FieldWrite[] = [];
+
+    this.traverseAST(funcNode, (node) => {
+      if (node.type !== 'assignment_expression' && node.type !== 'update_expression') return;
+      const target = node.namedChildren[0];
+      if (!target || target.type !== 'field_expression') return;
+
+      const base = target.namedChildren[0];
+      const fieldNode = target.namedChildren.find(child => child.type === 'field_identifier');
+      if (!base || base.type !== 'identifier' || !fieldNode) return;
+
+      const local = this.declaredType(funcNode, base.text);
+      const global = local ? null : this.declaredType(root, base.text, true);
+      const typeName = local || global;
+      if (!typeName) return;
+
+      const layout = layouts.get(typeName);
+      const field = layout?.fields.find(f => f.name === fieldNode.text);
+      if (!layout || !field) return;
+
+      writes.push({
+        entry: thread.entry,
+        objectKey: global ? `global:${base.text}`
+          : argAliases.has(base.text) ? `arg:${thread.arg}`
+          : `local:${thread.entry}:${funcName}:${base.text}`,
+        structName: layout.name,
+        field,
+        node
+      });
+    });
+
+    return writes;
+  }
+
+  /**
+   * 线程经调用图可达的各函数中指向线程实参的变量
+   * 入口函数的形参指向实参；调用时以这类变量为实参的形参同样指向它（worker(arg) 中 update(s) 的 s）
+   * 结果按调用图节点键
+   */
+  private threadArgumentAliases(entry: string, callGraph: CallGraph): Map<string, Set<string>> {
+    const result = new Map<string, Set<string>>();
+    const seeds = new Map<string, Set<string>>();
+    seeds.set(entry, new Set(this.parameterNames(callGraph.getFunction(entry)!.node)));
+
+    const pending = [entry];
+    while (pending.length > 0) {
+      const key = pending.pop()!;
+      const aliases = this.argumentAliases(callGraph.getFunction(key)!.node, seeds.get(key)!);
+      result.set(key, aliases);
+
+      for (const site of callGraph.getCallSites(key)) {
+        const argumentList = site.node.namedChildren.find(child => child.type === 'argument_list');
+        if (!argumentList) continue;
+        for (const callee of callGraph.calleesOf(site)) {
+          const parameters = this.parameterNames(callee.node);
+          const calleeSeeds = seeds.get(callee.key) || new Set<string>();
+          let grew = false;
+          argumentList.namedChildren.forEach((arg, i) => {
+            const from = this.aliasSource(arg);
+            if (from && aliases.has(from) && parameters[i] && !calleeSeeds.has(parameters[i])) {
+              calleeSeeds.add(parameters[i]);
+              grew = true;
+            }
+          });
+          if (grew) {
+            seeds.set(callee.key, calleeSeeds);
+            pending.push(callee.key);
+          }
+        }
+      }
+    }
+    return result;
+  }
+
+  /**
+   * 函数中指向线程实参的变量：seeds 中的形参，以及用它们（可带类型转换）初始化或赋值的局部变量
+   */
+  private argumentAliases(funcNode: ASTNode, seeds: Set<string>): Set<string> {
+    const aliases = new Set(seeds);
+
+    let changed = true;
+    while (changed) {
+      changed = false;
+      this.traverseAST(funcNode, (node) => {
+        if (node.type !== 'init_declarator' && node.type !== 'assignment_expression') return;
+        const target = node.namedChildren[0];
+        const value = node.namedChildren[node.namedChildren.length - 1];
+        if (!target || value === target) return;
+        let name: ASTNode | undefined = target;
+        while (name && name.type !== 'identifier' && name.type.endsWith('_declarator')) name = name.namedChildren[0];
+        const from = this.aliasSource(value);
+        if (name && name.type === 'identifier' && from && aliases.has(from) && !aliases.has(name.text)) {
+          aliases.add(name.text);
+          changed = true;
+        }
+      });
+    }
+    return aliases;
+  }
+
+  /**
+   * 表达式去掉类型转换和括号后的变量名（(struct stats *)arg 中的 arg）
+   */
+  private aliasSource(value: ASTNode | undefined): string | null {
+    let current = value;
+    while (current && (current.type === 'cast_expression' || current.type === 'parenthesized_expression')) {
+      current = current.namedChildren[current.namedChildren.length - 1];
+    }
+    return current && current.type === 'identifier' ? current.text : null;
+  }
+
+  /**
+   * 在作用域内查找变量声明的类型名（'struct tag' 或 typedef 名）
+   * topLevelOnly 为 true 时只看文件作用域的声明
+   */
+  private declaredType(scope: ASTNode, name: string, topLevelOnly: boolean = false): string | null {
+    const candidates = topLevelOnly
+      ? scope.namedChildren.filter(child => child.type === 'declaration')
+      : this.collectByTypes(scope, ['declaration', 'parameter_declaration']);
+
+    for (const decl of candidates) {
+      const typeNode = decl.namedChildren.find(child => child.type === 'struct_specifier' || child.type === 'type_identifier');
+      if (!typeNode) continue;
+      const declared = decl.namedChildren.some(child => child !== typeNode && this.declaresName(child, name));
+      if (!declared) continue;
+
+      if (typeNode.type === 'struct_specifier') {
+        const tag = typeNode.namedChildren.find(child => child.type === 'type_identifier');
+        return tag ? `struct ${tag.text}` : null;
+      }
+      return typeNode.text;
+    }
+    return null;
+  }
+
+  private declaresName(declarator: ASTNode, name: string): boolean {
+    if (declarator.type === 'identifier') {
+      return declarator.text === name;
+    }
+    if (!declarator.type.endsWith('_declarator')) {
+      return false;
+    }
+    // init_declarator 的初始值部分不算声明
+    const inner = declarator.type === 'init_declarator' ? [declarator.namedChildren[0]] : declarator.namedChildren;
+    return inner.some(child => !!child && this.declaresName(child, name));
+  }
+
+  private collectByTypes(node: ASTNode, types: string[]): ASTNode[] {
+    const result: ASTNode[] = [];
+    this.traverseAST(node, (child) => {
+      if (types.includes(child.type)) result.push(child);
+    });
+    return result;
+  }
+
+  /**
+   * 解析与源文件同目录（相对路径）的 #include "..." 头文件，用于查找结构体定义
+   */
+  private localHeaders(filePath: string, ast: ASTNode, provided?: { [file: string]: string }): Array<{ file: string; ast: ASTNode }> {
+    const headers: Array<{ file: string; ast: ASTNode }> = [];
+    for (const include of this.parser.extractIncludeDirectives(ast)) {
+      if (include.isSystemHeader) continue;
+      const headerPath = path.resolve(path.dirname(filePath), include.headerName);
+      try {
+        const source = provided ? provided[headerPath] : fs.readFileSync(headerPath, 'utf8');
+        if (source === undefined) continue;
+        if (!this.headerParser) this.headerParser = new CASTParser();
+        headers.push({ file: headerPath, ast: this.headerParser.parse(source) });
+      } catch {
+        // 找不到的头文件忽略
+      }
+    }
+    if (this.headerParser) this.headerParser.reset();
+    return headers;
+  }
+
+  /**
+   * 遍历 AST
+   */
+  private traverseAST(node: ASTNode, callback: (node: ASTNode) => void): void {
+    callback(node);
+    for (const child of node.namedChildren) {
+      this.traverseAST(child, callback);
+    }
+  }
+}
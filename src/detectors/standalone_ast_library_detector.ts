@@ -148,8 +148,8 @@ const STANDARD_LIBRARY_FUNCTIONS: { [key: string]: string[] } = {
 export class StandaloneASTLibraryDetector {
   private parser: CASTParser;
 
-  constructor() {
-    this.parser = new CASTParser();
+  constructor(parser: CASTParser = new CASTParser()) {
+    this.parser = parser;
   }
 
   /**
@@ -0,0 +1,501 @@
+import { CASTParser, ASTNode } from '../core/ast_parser';
+import { LoopAnalyzer } from '../core/loop_analyzer';
+import { LoopInfo } from '../interfaces/types';
+import { pureFunctions, sleepFunctions, spinHintFunctions } from '../utils/function_header_map';
+
+/**
+ * 独立的AST性能检测器（不依赖VSCode API）
+ * 包含循环不变量调用检测、嵌套循环中的线性查找检测、忙等待与休眠轮询检测
+ */
+export class StandaloneASTPerformanceDetector {
+  private parser: CASTParser;
+  private loopAnalyzer: LoopAnalyzer;
+
+  constructor(parser: CASTParser = new CASTParser()) {
+    this.parser = parser;
+    this.loopAnalyzer = new LoopAnalyzer();
+  }
+
+  /**
+   * 分析文件并返回所有问题列表
+   */
+  async analyzeFile(filePath: string, sourceCode: string): Promise<any[]> {
+    const sourceLines = sourceCode.split(/\r?\n/);
+    const issues: any[] = [];
+
+    try {
+      const ast = this.parser.parse(sourceCode);
+
+      const globals = new Set(
+        this.parser.extractVariableDeclarations(ast, sourceLines)
+          .filter(decl => decl.isGlobal)
+          .map(decl => decl.name)
+      );
+      const loops = this.parser.findLoops(ast).map(loop => this.loopAnalyzer.analyze(loop, pureFunctions, globals));
+
+      // 循环不变量调用检测
+      issues.push(...this.detectLoopInvariantCalls(loops, filePath, sourceLines));
+
+      // 嵌套循环中的线性查找检测
+      issues.push(...this.detectNestedLinearSearch(loops, filePath, sourceLines));
+
+      // 忙等待与休眠轮询检测
+      issues.push(...this.detectBusyWait(loops, ast, filePath, sourceLines));
+
+    } catch (error) {
+      console.error('AST parsing error in performance detector:', error);
+    }
+
+    return issues;
+  }
+
+  /**
+   * 循环不变量调用检测
+   * 纯函数调用的实参在循环内没有任何写入时，每次迭代的结果都相同，可以提到循环外
+   * 每个调用只在包含它的最内层循环上判断一次
+   */
+  detectLoopInvariantCalls(loops: LoopInfo[], filePath: string, sourceLines: string[]): any[] {
+    const issues: any[] = [];
+
+    for (const loop of loops) {
+      const reported = new Set<string>();
+
+      this.traverseAST(loop.node, (node) => {
+        if (node.type !== 'call_expression') return;
+        if (this.loopAnalyzer.enclosingLoop(node) !== loop.node) return;
+        if (!this.loopAnalyzer.isInIteratedPart(node, loop)) return;
+        // 外层调用已经是不变量时不再重复报告其内部调用
+        if (node.parent && this.hasInvariantCallAncestor(node, loop)) return;
+
+        if (!this.isInvariantCall(node, loop)) return;
+
+        const key = node.text;
+        if (reported.has(key)) return;
+        reported.add(key);
+
+        const inCondition = !!loop.conditionNode && this.isWithin(node, loop.conditionNode);
+        issues.push({
+          file: filePath,
+          line: node.startPosition.row + 1,
+          column: node.startPosition.column,
+          category: 'LoopInvariant',
+          message: inCondition
+            ? `循环条件中的纯函数调用 '${node.text}' 每次迭代都会重新求值，但其参数在循环中未被修改，可提到循环外`
+            : `循环内重复调用纯函数 '${node.text}'，其参数在循环中未被修改，可提到循环外`,
+          severity: 2, // Information
+          codeLine: sourceLines[node.startPosition.row] || ''
+        });
+      });
+    }
+
+    return issues;
+  }
+
+  /**
+   * 嵌套循环中的线性查找检测
+   * 内层循环逐个扫描数组（a[j]）或链表（p = p->next），用相等比较命中后 break/return 提前退出，
+   * 且外层循环同样随输入规模迭代时，整体是意外的 O(n²)
+   */
+  detectNestedLinearSearch(loops: LoopInfo[], filePath: string, sourceLines: string[]): any[] {
+    const issues: any[] = [];
+    const loopByNode = new Map<ASTNode, LoopInfo>(loops.map(loop => [loop.node, loop]));
+
+    for (const inner of loops) {
+      const outer = this.enclosingInputBoundLoop(inner, loopByNode);
+      if (!outer) continue;
+
+      const collection = this.scannedCollection(inner);
+      if (!collection) continue;
+
+      const hit = this.findEarlyExitEqualityTest(inner, collection);
+      if (!hit) continue;
+
+      const sameCollection = this.scannedCollection(outer)?.name === collection.name;
+      issues.push({
+        file: filePath,
+        line: inner.line,
+        column: inner.node.startPosition.column,
+        category: 'LinearSearchInLoop',
+        message: `嵌套循环中对 '${collection.name}' 的线性查找（外层循环第 ${outer.line} 行${sameCollection ? '遍历同一集合' : ''}），` +
+          `整体复杂度为 O(n²)；考虑预先建立哈希表，或排序后使用二分查找`,
+        severity: 2, // Information
+        codeLine: sourceLines[inner.node.startPosition.row] || ''
+      });
+    }
+
+    return issues;
+  }
+
+  /**
+   * 忙等待与休眠轮询检测
+   * 循环体为空（或只调用 sched_yield、_mm_pause 等让出/自旋提示）、条件中等待的状态在循环内没有被写入时，
+   * 循环只能等其他线程或信号处理函数修改该状态，期间持续占用一个 CPU 核；
+   * 循环体只调用 sleep/usleep 等休眠函数时是休眠轮询，唤醒延迟取决于休眠间隔
+   * 两者都应改为条件变量、信号量等阻塞等待
+   */
+  detectBusyWait(loops: LoopInfo[], ast: ASTNode, filePath: string, sourceLines: string[]): any[] {
+    const issues: any[] = [];
+
+    for (const loop of loops) {
+      // 带更新部分的 for 循环是计数循环，不是在等待
+      if (!loop.conditionNode || loop.updateNode) continue;
+      const body = this.waitingBody(loop);
+      if (!body) continue;
+
+      const watched = this.watchedState(loop.conditionNode);
+      if (!watched) continue;
+      // 空循环体时条件中的函数调用本身在做事（如 while (getchar() != '\n');），不算等待
+      if (!body.sleepCall && this.containsCall(loop.conditionNode, name => !/atomic|^__sync_/.test(name))) continue;
+
+      const base: any = {
+        file: filePath,
+        line: loop.line,
+        column: loop.node.startPosition.column,
+        codeLine: sourceLines[loop.node.startPosition.row] || ''
+      };
+      if (body.sleepCall) {
+        issues.push({
+          ...base,
+          category: 'SleepPolling',
+          message: `休眠轮询：循环每次调用 '${body.sleepCall}' 后重新检查 '${watched}'，唤醒延迟取决于休眠间隔，空闲时仍周期性占用 CPU；` +
+            `改用条件变量（pthread_cond_wait/pthread_cond_timedwait）、信号量或事件通知等阻塞等待`,
+          severity: 2 // Information
+        });
+        continue;
+      }
+
+      const hint = body.spinCall ? `（每次迭代只调用 '${body.spinCall}'）` : '';
+      const nonAtomic = this.isPlainVariable(watched, loop, ast)
+        ? `；'${watched}' 不是原子变量，编译器可以把读取提到循环外，使循环永不退出`
+        : '';
+      issues.push({
+        ...base,
+        category: 'BusyWait',
+        message: `忙等待：循环在 '${watched}' 被其他线程或信号修改前空转${hint}，持续占满一个 CPU 核${nonAtomic}；` +
+          `改用条件变量（pthread_cond_wait）、信号量或 futex 等阻塞等待`,
+        severity: 1 // Warning
+      });
+    }
+
+    return issues;
+  }
+
+  /**
+   * 循环体是否只在等待：每条语句都是空语句，或对休眠/让出函数的调用
+   * 返回其中的休眠调用与让出调用（都没有时为空循环体），循环体中有其他语句时返回 null
+   */
+  private waitingBody(loop: LoopInfo): { sleepCall?: string; spinCall?: string } | null {
+    const result: { sleepCall?: string; spinCall?: string } = {};
+    if (!loop.body) return result;
+
+    const statements = loop.body.type === 'compound_statement'
+      ? loop.body.namedChildren.filter(child => child.type !== 'comment')
+      : [loop.body];
+    for (const statement of statements) {
+      if (statement.type !== 'expression_statement') return null;
+      const expression = statement.namedChildren[0];
+      if (!expression) continue;   // 空语句 ;
+      const callee = expression.type === 'call_expression' ? expression.namedChildren[0] : undefined;
+      if (!callee || callee.type !== 'identifier') return null;
+      if (sleepFunctions.has(callee.text)) {
+        result.sleepCall = result.sleepCall || expression.text;
+      } else if (spinHintFunctions.has(callee.text)) {
+        result.spinCall = result.spinCall || expression.text;
+      } else {
+        return null;
+      }
+    }
+    return result;
+  }
+
+  /**
+   * 条件等待的外部状态：条件中第一个变量或字段（flag、q->ready）；
+   * 条件中有赋值或自增自减（循环自己推进状态）、或只有常量时返回 null
+   */
+  private watchedState(condition: ASTNode): string | null {
+    let writes = false;
+    let watched: string | null = null;
+
+    this.traverseAST(condition, (node) => {
+      if (node.type === 'assignment_expression' || node.type === 'update_expression') {
+        writes = true;
+      }
+      if (watched) return;
+      if (node.type === 'field_expression') {
+        watched = node.text;
+      } else if (node.type === 'identifier' && node.text !== 'NULL' && !/^[A-Z][A-Z0-9_]*$/.test(node.text)) {
+        const parent = node.parent;
+        const isCallee = !!parent && parent.type === 'call_expression' && parent.namedChildren[0] === node;
+        if (!isCallee) watched = node.text;
+      }
+    });
+
+    return writes ? null : watched;
+  }
+
+  /**
+   * 条件中是否调用了满足 predicate 的函数
+   */
+  private containsCall(condition: ASTNode, predicate: (name: string) => boolean): boolean {
+    let found = false;
+    this.traverseAST(condition, (node) => {
+      if (node.type !== 'call_expression') return;
+      const callee = node.namedChildren[0];
+      if (!callee || callee.type !== 'identifier' || predicate(callee.text)) found = true;
+    });
+    return found;
+  }
+
+  /**
+   * 等待的是声明为普通类型的变量：没有经原子操作读取，可见的声明（循环之前最近的一个）也不带
+   * _Atomic、atomic_int、sig_atomic_t 等原子类型；字段或找不到声明时无法判断，返回 false
+   */
+  private isPlainVariable(name: string, loop: LoopInfo, ast: ASTNode): boolean {
+    if (!loop.conditionNode || /atomic|__sync_/.test(loop.conditionNode.text)) return false;
+
+    let declaration: ASTNode | null = null;
+    this.traverseAST(ast, (node) => {
+      if (node.type !== 'declaration' || node.startPosition.row > loop.node.startPosition.row) return;
+      const declares = node.namedChildren.some(child => {
+        let current: ASTNode | undefined = child;
+        while (current && current.type !== 'identifier') {
+          if (!/declarator$/.test(current.type)) return false;
+          current = current.namedChildren[0];
+        }
+        return !!current && current.text === name;
+      });
+      if (declares) declaration = node;
+    });
+
+    if (!declaration) return false;
+    const typeText = (declaration as ASTNode).namedChildren
+      .filter(child => child.type !== 'identifier' && !/declarator$/.test(child.type))
+      .map(child => child.text)
+      .join(' ');
+    return !/atomic/i.test(typeText);
+  }
+
+  /**
+   * 查找包围该循环的最近一层依赖输入规模的循环
+   */
+  private enclosingInputBoundLoop(loop: LoopInfo, loopByNode: Map<ASTNode, LoopInfo>): LoopInfo | null {
+    let current = this.loopAnalyzer.enclosingLoop(loop.node);
+    while (current) {
+      const info = loopByNode.get(current);
+      if (info && this.loopAnalyzer.isInputBound(info)) {
+        return info;
+      }
+      current = this.loopAnalyzer.enclosingLoop(current);
+    }
+    return null;
+  }
+
+  /**
+   * 识别循环逐个扫描的集合
+   * 数组：循环变量作为下标出现（items[j]、g->nodes[j]）；链表：游标按 p = p->next 前进
+   */
+  private scannedCollection(loop: LoopInfo): { name: string; cursor: string; kind: 'array' | 'list' } | null {
+    const cursors = this.iterationVariables(loop);
+    if (cursors.size === 0) return null;
+
+    let result: { name: string; cursor: string; kind: 'array' | 'list' } | null = null;
+    const parts = [loop.conditionNode, loop.updateNode, loop.body].filter((n): n is ASTNode => !!n);
+    for (const part of parts) {
+      this.traverseAST(part, (node) => {
+        if (result) return;
+        if (node.type === 'subscript_expression') {
+          const array = node.namedChildren[0];
+          const index = node.namedChildren[1];
+          if (array && index && index.type === 'identifier' && cursors.has(index.text)) {
+            result = { name: array.text, cursor: index.text, kind: 'array' };
+          }
+        } else if (node.type === 'assignment_expression') {
+          const left = node.namedChildren[0];
+          const right = node.namedChildren[1];
+          if (left && right && left.type === 'identifier' && cursors.has(left.text) &&
+              right.type === 'field_expression' && this.loopAnalyzer.baseIdentifier(right) === left.text) {
+            result = { name: this.listHead(loop, left.text), cursor: left.text, kind: 'list' };
+          }
+        }
+      });
+    }
+    return result;
+  }
+
+  /**
+   * 循环变量：for 更新部分或循环体中以 ++/--/+=/p = p->next 方式推进的变量
+   */
+  private iterationVariables(loop: LoopInfo): Set<string> {
+    const vars = new Set<string>();
+    const parts = [loop.updateNode, loop.body].filter((n): n is ASTNode => !!n);
+    for (const part of parts) {
+      this.traverseAST(part, (node) => {
+        if (node.type === 'update_expression') {
+          const target = node.namedChildren[0];
+          if (target && target.type === 'identifier') vars.add(target.text);
+        } else if (node.type === 'assignment_expression') {
+          const target = node.namedChildren[0];
+          const value = node.namedChildren[1];
+          if (target && target.type === 'identifier' && value &&
+              (/^[+-]=/.test(node.text.slice(target.text.length).trim()) ||
+               (value.type === 'field_expression' && this.loopAnalyzer.baseIdentifier(value) === target.text))) {
+            vars.add(target.text);
+          }
+        }
+      });
+    }
+    return vars;
+  }
+
+  /**
+   * 链表扫描的起点：for 初始化或循环前最近一次对游标的赋值，找不到时用游标名
+   */
+  private listHead(loop: LoopInfo, cursor: string): string {
+    const init = loop.init ? loop.init.match(new RegExp(`\\b${cursor}\\s*=\\s*([^;,]+)`)) : null;
+    if (init) return init[1].trim();
+
+    const block = loop.node.parent;
+    if (block) {
+      const index = block.namedChildren.indexOf(loop.node);
+      for (let i = index - 1; i >= 0; i--) {
+        const match = block.namedChildren[i].text.match(new RegExp(`\\b${cursor}\\s*=\\s*([^;,]+)`));
+        if (match) return match[1].trim();
+      }
+    }
+    return cursor;
+  }
+
+  /**
+   * 在循环体中查找以集合元素参与相等比较、命中后 break/return 的 if 语句
+   */
+  private findEarlyExitEqualityTest(loop: LoopInfo, collection: { cursor: string }): ASTNode | null {
+    if (!loop.body) return null;
+    let found: ASTNode | null = null;
+
+    this.traverseAST(loop.body, (node) => {
+      if (found || node.type !== 'if_statement') return;
+      if (this.loopAnalyzer.enclosingLoop(node) !== loop.node) return;
+
+      const condition = node.namedChildren[0];
+      const consequence = node.namedChildren[1];
+      if (!condition || !consequence) return;
+      if (!this.isEqualityOnCursor(condition, collection.cursor)) return;
+
+      let exits = false;
+      this.traverseAST(consequence, (child) => {
+        if (child.type === 'return_statement' ||
+            (child.type === 'break_statement' && this.loopAnalyzer.enclosingLoop(child) === loop.node)) {
+          exits = true;
+        }
+      });
+      if (exits) found = node;
+    });
+
+    return found;
+  }
+
+  /**
+   * 条件中是否有涉及游标所指元素的相等比较：==、strcmp(...) == 0、!strcmp(...)、memcmp 等
+   */
+  private isEqualityOnCursor(condition: ASTNode, cursor: string): boolean {
+    const mentionsCursor = (node: ASTNode) => new RegExp(`\\b${cursor}\\b`).test(node.text);
+    let result = false;
+
+    this.traverseAST(condition, (node) => {
+      if (result) return;
+      if (node.type === 'binary_expression' && /^[^=!<>]*==/.test(node.text.replace(/\([^()]*\)/g, '()')) &&
+          mentionsCursor(node)) {
+        result = true;
+      } else if (node.type === 'call_expression') {
+        const callee = node.namedChildren[0];
+        if (callee && ['strcmp', 'strncmp', 'strcasecmp', 'strncasecmp', 'memcmp'].includes(callee.text) &&
+            mentionsCursor(node)) {
+          result = true;
+        }
+      }
+    });
+
+    return result;
+  }
+
+  /**
+   * 判断调用在循环内是否不变：被调函数是纯函数，实参中没有副作用，且引用的变量都不在循环写集合中
+   */
+  private isInvariantCall(call: ASTNode, loop: LoopInfo): boolean {
+    const callee = call.namedChildren[0];
+    if (!callee || callee.type !== 'identifier' || !pureFunctions.has(callee.text)) {
+      return false;
+    }
+
+    const argumentList = call.namedChildren.find(child => child.type === 'argument_list');
+    if (!argumentList) {
+      return false;
+    }
+
+    let invariant = true;
+    for (const arg of argumentList.namedChildren) {
+      this.traverseAST(arg, (node) => {
+        if (!invariant) return;
+        switch (node.type) {
+          case 'assignment_expression':
+          case 'update_expression':
+            invariant = false;
+            break;
+          case 'call_expression': {
+            const inner = node.namedChildren[0];
+            if (!inner || inner.type !== 'identifier' || !pureFunctions.has(inner.text)) {
+              invariant = false;
+            }
+            break;
+          }
+          case 'identifier':
+            // 字段名（p->field 中的 field）是 field_identifier，不会走到这里
+            if (loop.writtenVariables.has(node.text)) {
+              invariant = false;
+            }
+            break;
+        }
+      });
+    }
+
+    return invariant;
+  }
+
+  /**
+   * 检查调用外层是否已有同一循环内的不变量调用
+   */
+  private hasInvariantCallAncestor(node: ASTNode, loop: LoopInfo): boolean {
+    let current = node.parent;
+    while (current && current !== loop.node) {
+      if (current.type === 'call_expression' && this.isInvariantCall(current, loop)) {
+        return true;
+      }
+      current = current.parent;
+    }
+    return false;
+  }
+
+  /**
+   * 判断 node 是否位于 container 子树内
+   */
+  private isWithin(node: ASTNode, container: ASTNode): boolean {
+    let current: ASTNode | undefined = node;
+    while (current) {
+      if (current === container) {
+        return true;
+      }
+      current = current.parent;
+    }
+    return false;
+  }
+
+  /**
+   * 遍历 AST
+   */
+  private traverseAST(node: ASTNode, callback: (node: ASTNode) => void): void {
+    callback(node);
+    for (const child of node.namedChildren) {
+      this.traverseAST(child, callback);
+    }
+  }
+}
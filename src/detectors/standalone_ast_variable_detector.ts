@@ -1,14 +1,17 @@
 import { CASTParser, VariableDeclaration, ASTNode } from '../core/ast_parser';
+import { ControlFlowGraph } from '../core/cfg';
+import { BitSet, nodeUseDef, solveBitVector } from '../core/dataflow';
+import { pureFunctions } from '../utils/function_header_map';
 
 /**
  * 独立的AST变量检测器（不依赖VSCode API）
- * 检测未初始化变量使用和野指针解引用
+ * 检测未初始化变量使用、野指针解引用，以及死存储和被丢弃的计算结果
  */
 export class StandaloneASTVariableDetector {
   private parser: CASTParser;
 
-  constructor() {
-    this.parser = new CASTParser();
+  constructor(parser: CASTParser = new CASTParser()) {
+    this.parser = parser;
   }
 
   /**
@@ -40,6 +43,9 @@ export class StandaloneASTVariableDetector {
       const nullPointerIssues = this.checkNullPointerDereference(ast, sourceLines, filePath);
       issues.push(...nullPointerIssues);
 
+      // 死存储与被丢弃的计算结果
+      issues.push(...this.detectDeadStores(ast, sourceLines, filePath));
+
     } catch (error) {
       console.error('AST parsing error:', error);
       // 如果 AST 解析失败，返回空问题列表而不是崩溃
@@ -109,7 +115,8 @@ export class StandaloneASTVariableDetector {
         category: 'Uninitialized',
         message: `变量 '${variable.name}' 在初始化前被使用`,
         severity: 1, // Warning
-        codeLine: sourceLines[usage.row] || ''
+        codeLine: sourceLines[usage.row] || '',
+        originLine: variable.position.row + 1
       });
     }
 
@@ -128,7 +135,8 @@ export class StandaloneASTVariableDetector {
           category: 'NullPointer',
           message: `潜在野指针解引用：指针 '${variable.name}' 未初始化`,
           severity: 0, // Error
-          codeLine: sourceLines[deref.row] || ''
+          codeLine: sourceLines[deref.row] || '',
+          originLine: variable.position.row + 1
         });
       }
     }
@@ -178,7 +186,8 @@ export class StandaloneASTVariableDetector {
             category: 'NullPointer',
             message: `潜在空指针解引用：指针 '${pointer.name}' 可能为 NULL`,
             severity: 0, // Error
-            codeLine: sourceLines[deref.row] || ''
+            codeLine: sourceLines[deref.row] || '',
+            originLine: pointer.position.row + 1
           });
         }
       }
@@ -187,6 +196,258 @@ export class StandaloneASTVariableDetector {
     return issues;
   }
 
+  /**
+   * 死存储检测
+   * 对每个函数在控制流图上做后向活跃变量分析（位向量，每个局部变量一位），报告：
+   * 写入后在任何路径上都不再被读取的赋值、自增自减和非常量初始值；只写不读的局部变量（每个变量报告一次）；
+   * 返回值被忽略的纯函数调用与结果被丢弃的算术表达式
+   * static、volatile、数组以及被取过地址的变量可能经由其他途径读取，不跟踪
+   */
+  detectDeadStores(ast: ASTNode, sourceLines: string[], filePath: string): any[] {
+    const issues: any[] = [];
+    const report = (node: ASTNode, category: string, message: string, severity: number) => {
+      issues.push({
+        file: filePath,
+        line: node.startPosition.row + 1,
+        column: node.startPosition.column,
+        category,
+        message,
+        severity,
+        codeLine: sourceLines[node.startPosition.row] || ''
+      });
+    };
+
+    this.traverseAST(ast, (func) => {
+      if (func.type !== 'function_definition') return;
+      const resolve = (identifier: ASTNode) => this.declarationKey(identifier, func);
+      const locals = this.trackedLocals(func, resolve);
+
+      // 被丢弃的计算结果
+      this.traverseAST(func, (statement) => {
+        if (statement.type !== 'expression_statement') return;
+        const expression = statement.namedChildren[0];
+        if (!expression) return;
+        const callee = expression.type === 'call_expression' ? expression.namedChildren[0] : undefined;
+        if (callee && callee.type === 'identifier' && pureFunctions.has(callee.text)) {
+          report(expression, 'UnusedResult', `纯函数调用 '${expression.text}' 的返回值被忽略，这次调用没有任何效果`, 1);
+        } else if (expression.type === 'binary_expression' && this.isSideEffectFree(expression)) {
+          report(expression, 'UnusedResult', `表达式 '${expression.text}' 的结果被丢弃，这条语句没有任何效果`, 1);
+        }
+      });
+
+      if (locals.size === 0) return;
+      const graph = ControlFlowGraph.build(func);
+      const keys = Array.from(locals.keys());
+      const bit = new Map(keys.map((key, index) => [key, index]));
+      const useDefs = graph.nodes.map(node => nodeUseDef(node, resolve));
+      const toBits = (set: Set<string>) => {
+        const bits = new BitSet(keys.length);
+        for (const key of set) {
+          const index = bit.get(key);
+          if (index !== undefined) bits.add(index);
+        }
+        return bits;
+      };
+
+      const live = solveBitVector(graph, {
+        direction: 'backward',
+        meet: 'union',
+        size: keys.length,
+        gen: useDefs.map(useDef => toBits(useDef.uses)),
+        kill: useDefs.map(useDef => toBits(useDef.defs)),
+        boundary: new BitSet(keys.length)
+      });
+
+      // 只写不读的局部变量：整个函数中没有任何读取
+      const read = new Set<string>();
+      useDefs.forEach(useDef => useDef.uses.forEach(key => read.add(key)));
+      const writeOnly = new Set<string>();
+      for (const [key, local] of locals) {
+        if (read.has(key) || local.isParameter) continue;
+        if (!useDefs.some(useDef => useDef.defs.has(key))) continue;
+        writeOnly.add(key);
+        report(local.node, 'DeadStore', `局部变量 '${local.name}' 只被写入、从未被读取，对它的赋值及相关计算都可以删除`, 2);
+      }
+
+      for (const id of this.reachableNodes(graph)) {
+        for (const write of useDefs[id].writes) {
+          const index = bit.get(write.key);
+          if (index === undefined || writeOnly.has(write.key) || live.out[id].has(index)) continue;
+          const message = this.deadStoreMessage(write.name, write.node);
+          if (message) report(write.node, 'DeadStore', message, 2);
+        }
+      }
+    });
+
+    return issues.sort((a, b) => a.line - b.line);
+  }
+
+  /**
+   * 函数内可跟踪的局部变量与形参：声明键（见 declarationKey）-> 名字与声明节点
+   * 不同块中的同名变量（包括内层块遮蔽外层的变量）是不同的键
+   */
+  private trackedLocals(func: ASTNode, resolve: (identifier: ASTNode) => string):
+      Map<string, { name: string; node: ASTNode; isParameter: boolean }> {
+    const locals = new Map<string, { name: string; node: ASTNode; isParameter: boolean }>();
+    const excluded = new Set<string>();
+
+    this.traverseAST(func, (node) => {
+      if (node.type === 'declaration' || node.type === 'parameter_declaration') {
+        const qualifiers = node.namedChildren
+          .filter(child => child.type === 'storage_class_specifier' || child.type === 'type_qualifier')
+          .map(child => child.text);
+        for (const child of node.namedChildren) {
+          const declarator = child.type === 'init_declarator' ? child.namedChildren[0] : child;
+          if (!declarator || (declarator.type !== 'identifier' && !/declarator$/.test(declarator.type))) continue;
+          const identifier = this.declaredIdentifier(declarator);
+          if (!identifier) continue;
+          const key = this.keyOf(identifier);
+          if (qualifiers.some(q => q === 'static' || q === 'volatile' || q === 'extern') ||
+              this.containsType(declarator, 'array_declarator') || this.containsType(declarator, 'function_declarator')) {
+            excluded.add(key);
+          } else if (!locals.has(key)) {
+            locals.set(key, { name: identifier.text, node: child, isParameter: node.type === 'parameter_declaration' });
+          }
+        }
+      } else if (node.type === 'pointer_expression' && node.text.trim().startsWith('&')) {
+        // 取地址后可能经由指针读写
+        let target: ASTNode | undefined = node.namedChildren[0];
+        while (target && target.type === 'parenthesized_expression') target = target.namedChildren[0];
+        if (target && target.type === 'identifier') excluded.add(resolve(target));
+      }
+    });
+
+    for (const key of excluded) locals.delete(key);
+    return locals;
+  }
+
+  /**
+   * 把函数内的标识符解析到声明它的声明器，键为"名字@行:列"；
+   * 由内向外查找各层块（只看标识符之前的声明）、for 的初始化声明和形参，找不到时（全局变量等）返回名字本身
+   */
+  private declarationKey(identifier: ASTNode, func: ASTNode): string {
+    const name = identifier.text;
+    const position = identifier.startPosition;
+    const precedes = (node: ASTNode) => node.startPosition.row < position.row ||
+      (node.startPosition.row === position.row && node.startPosition.column <= position.column);
+
+    for (let scope = identifier.parent; scope; scope = scope.parent) {
+      let declarations: ASTNode[] = [];
+      if (scope.type === 'compound_statement' || scope.type === 'case_statement') {
+        declarations = scope.namedChildren.filter(child => child.type === 'declaration' && precedes(child));
+      } else if (scope.type === 'for_statement') {
+        declarations = scope.namedChildren.filter(child => child.type === 'declaration');
+      } else if (scope === func) {
+        const declarator = func.namedChildren.find(child => /declarator$/.test(child.type));
+        const parameters = declarator ? this.findFirst(declarator, 'parameter_list') : null;
+        if (parameters) declarations = parameters.namedChildren.filter(child => child.type === 'parameter_declaration');
+      }
+      for (const declaration of declarations) {
+        for (const child of declaration.namedChildren) {
+          const declarator = child.type === 'init_declarator' ? child.namedChildren[0] : child;
+          if (!declarator || (declarator.type !== 'identifier' && !/declarator$/.test(declarator.type))) continue;
+          const declared = this.declaredIdentifier(declarator);
+          if (declared && declared.text === name) return this.keyOf(declared);
+        }
+      }
+      if (scope === func) break;
+    }
+    return name;
+  }
+
+  private keyOf(identifier: ASTNode): string {
+    return `${identifier.text}@${identifier.startPosition.row}:${identifier.startPosition.column}`;
+  }
+
+  /**
+   * 死存储的说明；写入的值另有用途（如 if ((x = f()) != 0)、a = x = 0）或是防御性的常量初始值时返回 null
+   */
+  private deadStoreMessage(name: string, write: ASTNode): string | null {
+    if (write.type === 'init_declarator') {
+      const value = write.namedChildren[write.namedChildren.length - 1];
+      if (!value || value === write.namedChildren[0] || this.isConstantInitializer(value)) return null;
+      return `'${name}' 的初始值 '${value.text}' 在之后的任何路径上都不会被读取（读取前总会被覆盖），这次初始化是多余的`;
+    }
+
+    const parent = write.parent;
+    const discarded = !!parent && (parent.type === 'expression_statement' || parent.type === 'comma_expression' ||
+      parent.type === 'for_statement');
+    if (!discarded) return null;
+    if (write.type === 'update_expression') {
+      return `'${name}' 自增/自减后的值在之后的任何路径上都不会被读取（死存储）`;
+    }
+    return `赋给 '${name}' 的值在之后的任何路径上都不会被读取（死存储）；检查是否遗漏了使用，或删除这次赋值`;
+  }
+
+  /**
+   * 从函数入口可达的节点
+   */
+  private reachableNodes(graph: ControlFlowGraph): number[] {
+    const seen = new Set<number>([graph.entry]);
+    const queue = [graph.entry];
+    for (let head = 0; head < queue.length; head++) {
+      for (const edge of graph.nodes[queue[head]].succ) {
+        if (!seen.has(edge.to)) {
+          seen.add(edge.to);
+          queue.push(edge.to);
+        }
+      }
+    }
+    return queue;
+  }
+
+  private isConstantInitializer(value: ASTNode): boolean {
+    return /^(-?[0-9][\w.]*|'.*'|".*"|NULL|nullptr|true|false|\{\s*0?\s*\}|\(\s*void\s*\*\s*\)\s*0)$/.test(value.text.trim());
+  }
+
+  /**
+   * 表达式中没有调用、赋值或自增自减
+   */
+  private isSideEffectFree(expression: ASTNode): boolean {
+    let pure = true;
+    this.traverseAST(expression, (node) => {
+      if (node.type === 'call_expression' || node.type === 'assignment_expression' || node.type === 'update_expression') {
+        pure = false;
+      }
+    });
+    return pure;
+  }
+
+  private declaredIdentifier(declarator: ASTNode | undefined): ASTNode | null {
+    let current = declarator;
+    while (current && current.type !== 'identifier') {
+      current = current.namedChildren.find(child => child.type === 'identifier' || /declarator$/.test(child.type));
+    }
+    return current || null;
+  }
+
+  private findFirst(node: ASTNode, type: string): ASTNode | null {
+    if (node.type === type) return node;
+    for (const child of node.namedChildren) {
+      const found = this.findFirst(child, type);
+      if (found) return found;
+    }
+    return null;
+  }
+
+  private containsType(node: ASTNode, type: string): boolean {
+    let found = false;
+    this.traverseAST(node, (child) => {
+      if (child.type === type) found = true;
+    });
+    return found;
+  }
+
+  /**
+   * 遍历 AST
+   */
+  private traverseAST(node: ASTNode, callback: (node: ASTNode) => void): void {
+    callback(node);
+    for (const child of node.namedChildren) {
+      this.traverseAST(child, callback);
+    }
+  }
+
   /**
    * 检查是否是结构体字段
    */
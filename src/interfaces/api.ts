@@ -0,0 +1,128 @@
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { AnalysisEngine, IssueRecord, analyzeSource } from '../core/engine';
+import { FindingDeduplicator } from '../core/fingerprint';
+import { WorkerPool } from '../core/worker_pool';
+
+export type { IssueRecord };
+export { analyzeSource };
+
+export interface ScanOptions {
+  paths: string[];          // 要扫描的文件或目录（目录递归查找）
+  extensions?: string[];    // 默认 ['.c']；加入 '.h' 时每个头文件单独分析一次
+  jobs?: number;            // 并行工作线程数，默认 CPU 核数；1 表示在当前线程中分析
+  signal?: AbortSignal;     // 取消扫描
+}
+
+// 递归查找时跳过的目录
+const SKIPPED_DIRS = new Set(['.git', 'node_modules', 'out', '.vscode']);
+
+/**
+ * 公共 API：以异步迭代器流式返回问题记录（不依赖VSCode API）
+ * 文件在工作线程池中并行分析，按完成顺序产出；signal 触发后终止工作线程并以 AbortError 结束迭代
+ *
+ *   for await (const issue of scan({ paths: ['src'] })) { ... }
+ */
+export async function* scan(options: ScanOptions): AsyncIterable<IssueRecord> {
+  const signal = options.signal;
+  throwIfAborted(signal);
+
+  const extensions = options.extensions || ['.c'];
+  // 路径重叠时同一文件只分析一次；头文件中的发现按指纹去重
+  const files = Array.from(new Set(options.paths.flatMap(p => collectFiles(path.resolve(p), extensions))));
+  const deduplicator = new FindingDeduplicator();
+  const jobs = Math.max(1, options.jobs || os.cpus().length);
+
+  if (jobs === 1 || files.length <= 1) {
+    const engine = new AnalysisEngine();
+    for (const file of files) {
+      throwIfAborted(signal);
+      yield* deduplicator.filter(await analyzeFileSafely(engine, file), file);
+    }
+    return;
+  }
+
+  const pool = new WorkerPool<{ file: string }, IssueRecord[]>(path.join(__dirname, '..', 'core', 'scan_worker.js'), jobs);
+  const pending = new Map<number, Promise<{ index: number; issues: IssueRecord[] }>>();
+  let next = 0;
+
+  try {
+    while (next < files.length || pending.size > 0) {
+      // 保持有限的在途任务数，避免一次性提交全部文件
+      while (next < files.length && pending.size < jobs * 2) {
+        const index = next++;
+        pending.set(index, pool.run({ file: files[index] })
+          .catch((error): IssueRecord[] => {
+            console.error(`分析文件 ${files[index]} 时发生错误:`, error.message);
+            return [];
+          })
+          .then(issues => ({ index, issues })));
+      }
+
+      const done = await raceWithAbort(Promise.race(pending.values()), signal);
+      pending.delete(done.index);
+      yield* deduplicator.filter(done.issues, files[done.index]);
+    }
+  } finally {
+    await pool.close();
+  }
+}
+
+/**
+ * 收集待扫描文件；单个文件路径直接使用
+ */
+function collectFiles(target: string, extensions: string[]): string[] {
+  const stat = fs.statSync(target);
+  if (stat.isFile()) {
+    return [target];
+  }
+
+  const files: string[] = [];
+  const walk = (dir: string) => {
+    for (const entry of fs.readdirSync(dir, { withFileTypes: true }).sort((a, b) => a.name.localeCompare(b.name))) {
+      const full = path.join(dir, entry.name);
+      if (entry.isDirectory()) {
+        if (!SKIPPED_DIRS.has(entry.name)) walk(full);
+      } else if (extensions.some(ext => entry.name.endsWith(ext))) {
+        files.push(full);
+      }
+    }
+  };
+  walk(target);
+  return files;
+}
+
+async function analyzeFileSafely(engine: AnalysisEngine, file: string): Promise<IssueRecord[]> {
+  try {
+    return await engine.analyzeSource(file, fs.readFileSync(file, 'utf8'));
+  } catch (error: any) {
+    console.error(`分析文件 ${file} 时发生错误:`, error.message);
+    return [];
+  }
+}
+
+function abortError(): Error {
+  const error = new Error('The scan was aborted');
+  error.name = 'AbortError';
+  return error;
+}
+
+function throwIfAborted(signal?: AbortSignal): void {
+  if (signal && signal.aborted) {
+    throw abortError();
+  }
+}
+
+function raceWithAbort<T>(promise: Promise<T>, signal?: AbortSignal): Promise<T> {
+  if (!signal) return promise;
+  throwIfAborted(signal);
+  return new Promise<T>((resolve, reject) => {
+    const onAbort = () => reject(abortError());
+    signal.addEventListener('abort', onAbort, { once: true });
+    promise.then(
+      value => { signal.removeEventListener('abort', onAbort); resolve(value); },
+      error => { signal.removeEventListener('abort', onAbort); reject(error); }
+    );
+  });
+}
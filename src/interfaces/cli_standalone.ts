@@ -1,6 +1,10 @@
+#!/usr/bin/env node
 import * as path from 'path';
 import * as fs from 'fs';
 import { Issue } from './types';
+import type { BuildConfiguration } from '../core/presence';
+import type { HeapPhaseProfiler } from '../core/heap_profile';
+import type { StagedFile } from '../core/staged';
 
 // 设置控制台输出编码为UTF-8
 if (process.platform === 'win32') {
@@ -14,14 +18,21 @@ if (process.platform === 'win32') {
 }
 
 // 独立的AST分析函数（不依赖VSCode API）
-async function analyzeDir(dir: string): Promise<Issue[]> {
+// 提供 sink 时每个文件的问题分析完即交给 sink，不在内存中累积（流式报告）
+// extensions 含 '.h' 时（--headers）每个头文件单独分析一次，头文件中的发现按指纹跨翻译单元去重
+// 给出构建配置时（--configs）每个文件仍只分析一次，问题标注其适用的配置
+// 给出堆分析器时（--heap-profile）按阶段采样各文件的内存分配
+async function analyzeDir(dir: string, sink?: (fileIssues: Issue[]) => void, extensions: string[] = ['.c'],
+                          configurations?: BuildConfiguration[], profiler?: HeapPhaseProfiler): Promise<Issue[]> {
   const issues: Issue[] = [];
 
   try {
-    // 获取目录中的所有C文件
-    const files = fs.readdirSync(dir)
-      .filter(f => f.endsWith('.c'))
-      .map(f => path.join(dir, f));
+    // 获取目录中的所有C文件（以及头文件）
+    const files = listCFiles(dir, extensions);
+    const { FindingDeduplicator } = await import('../core/fingerprint');
+    const deduplicator = new FindingDeduplicator();
+    let useAST = true;
+    let engine: any = null;
 
     for (const filePath of files) {
       try {
@@ -29,64 +40,25 @@ async function analyzeDir(dir: string): Promise<Issue[]> {
         const sourceLines = sourceCode.split(/\r?\n/);
 
         // 尝试使用AST分析，如果失败则回退到文本分析
-        let useAST = true;
-        let astParser: any = null;
-        let varDetector: any = null;
-        let libDetector: any = null;
-        let advDetector: any = null;
-
-        try {
-          const { CASTParser } = await import('../core/ast_parser');
-          const { StandaloneASTVariableDetector } = await import('../detectors/standalone_ast_variable_detector');
-          const { StandaloneASTLibraryDetector } = await import('../detectors/standalone_ast_library_detector');
-          const { StandaloneASTAdvancedDetector } = await import('../detectors/standalone_ast_advanced_detector');
-
-          astParser = new CASTParser();
-          varDetector = new StandaloneASTVariableDetector();
-          libDetector = new StandaloneASTLibraryDetector();
-          advDetector = new StandaloneASTAdvancedDetector();
-        } catch (error: any) {
-          console.warn('AST 解析器初始化失败，将使用文本分析回退方案:', error.message);
-          useAST = false;
+        if (!engine && useAST) {
+          try {
+            const { AnalysisEngine } = await import('../core/engine');
+            engine = new AnalysisEngine(configurations);
+            if (profiler) engine.setHeapProfiler(profiler);
+          } catch (error: any) {
+            console.warn('AST 解析器初始化失败，将使用文本分析回退方案:', error.message);
+            useAST = false;
+          }
         }
 
-        if (useAST && astParser && varDetector && libDetector && advDetector) {
-          // 使用AST分析
-          const ast = astParser.parse(sourceCode);
-
-          // 变量检测
-          const variableIssues = await varDetector.analyzeFile(filePath, sourceCode);
-
-          // 库函数检测
-          const libraryIssues = await libDetector.analyzeFile(filePath, sourceCode);
-          const headerSpellingIssues = await libDetector.checkHeaderSpelling(filePath, sourceCode);
-
-          // 高级检测
-          const advancedIssues = await advDetector.analyzeFile(filePath, sourceCode);
-
-          // 合并所有问题
-          const allIssues = [
-            ...variableIssues,
-            ...libraryIssues,
-            ...headerSpellingIssues,
-            ...advancedIssues
-          ];
-
-          // 转换问题为Issue格式
-          for (const issue of allIssues) {
-            const codeLine = sourceLines[issue.line - 1] || '';
-            issues.push({
-              file: filePath,
-              line: issue.line,
-              category: issue.category,
-              message: issue.message,
-              codeLine: codeLine.trim()
-            });
-          }
+        // 使用AST分析（变量、库函数、头文件拼写、高级、性能、并发检测），否则回退到文本分析
+        const fileIssues: Issue[] = deduplicator.filter(useAST && engine
+          ? await engine.analyzeSource(filePath, sourceCode)
+          : fallbackTextAnalysis(filePath, sourceCode, sourceLines), filePath);
+        if (sink) {
+          sink(fileIssues);
         } else {
-          // 回退到文本分析
-          const textIssues = fallbackTextAnalysis(filePath, sourceCode, sourceLines);
-          issues.push(...textIssues);
+          issues.push(...fileIssues);
         }
 
       } catch (fileError) {
@@ -98,15 +70,15 @@ async function analyzeDir(dir: string): Promise<Issue[]> {
   } catch (error) {
     console.error(`分析目录 ${dir} 时发生错误:`, error);
     // 如果AST分析失败，回退到简单的文本分析
-    return fallbackTextAnalysisForDir(dir);
+    return fallbackTextAnalysisForDir(dir, extensions);
   }
 
   return issues;
 }
 
 // 目录级别的文本分析作为回退方案
-function fallbackTextAnalysisForDir(dir: string): Issue[] {
-  const files = fs.readdirSync(dir).filter(f => f.endsWith('.c'));
+function fallbackTextAnalysisForDir(dir: string, extensions: string[] = ['.c']): Issue[] {
+  const files = fs.readdirSync(dir).filter(f => extensions.some(ext => f.endsWith(ext)));
   const issues: Issue[] = [];
 
   for (const file of files) {
@@ -377,11 +349,41 @@ function printIssues(issues: any[]) {
 
   for (const issue of filteredIssues) {
     const relativePath = path.relative(process.cwd(), issue.file);
-    console.log(`${relativePath}:${issue.line}: [${issue.category}] ${issue.message}`);
+    const confirmation = issue.confirmation ? ` (${CONFIRMATION_LABELS[issue.confirmation]})` : '';
+    const hotness = issue.hotness
+      ? ` {${issue.hotness.function}: ${issue.hotness.calls} 次调用, ${(issue.hotness.timeNs / 1e6).toFixed(2)} ms}`
+      : '';
+    const configurations = issue.configurations ? ` <${issue.configurations.join(', ')}>` : '';
+    console.log(`${relativePath}:${issue.line}: [${issue.category}]${confirmation}${hotness}${configurations} ${issue.message}`);
     console.log(`    ${issue.codeLine}`);
+    if (issue.presenceCondition) {
+      console.log(`    #if ${issue.presenceCondition}`);
+    }
+  }
+
+  if (filteredIssues.some(issue => issue.confirmation)) {
+    const confirmed = filteredIssues.filter(issue => issue.confirmation === 'confirmed').length;
+    const notRun = filteredIssues.filter(issue => issue.confirmation === 'not-run').length;
+    console.log(`\n运行时确认: ${confirmed} 个已确认, ${filteredIssues.length - confirmed - notRun} 个未确认, ${notRun} 个未运行`);
+  }
+
+  if (filteredIssues.some(issue => issue.configurations)) {
+    const perConfiguration = new Map<string, number>();
+    for (const issue of filteredIssues) {
+      for (const name of issue.configurations || []) {
+        perConfiguration.set(name, (perConfiguration.get(name) || 0) + 1);
+      }
+    }
+    console.log('\n按构建配置: ' + Array.from(perConfiguration).map(([name, count]) => `${name}=${count}`).join(', '));
   }
 }
 
+const CONFIRMATION_LABELS: { [key: string]: string } = {
+  'confirmed': '运行时已确认',
+  'unconfirmed': '运行时未复现',
+  'not-run': '未能运行'
+};
+
 function printTables() {
   console.log('\n=== 基于AST的C代码安全扫描器 ===');
   console.log('支持的检测功能:');
@@ -393,22 +395,636 @@ function printTables() {
   console.log('- 数值范围检查');
   console.log('- 内存泄漏检测');
   console.log('- printf/scanf 格式检查');
+  console.log('- 循环不变量调用检测');
+  console.log('- 嵌套循环线性查找检测');
+  console.log('- 多线程结构体伪共享检测');
+  console.log('- 忙等待与休眠轮询检测');
+  console.log('- 临界区内阻塞调用检测');
+  console.log('- 死存储与被丢弃的计算结果检测');
+}
+
+// 需要取值的命令行选项（--name value 或 --name=value）
+const VALUE_OPTIONS = new Set<string>(['harness', 'instrument', 'runtime-log', 'hotness', 'store', 'category', 'path',
+  'fingerprint', 'limit', 'format', 'output', 'rev', 'cache-dir', 'socket', 'configs',
+  'metrics', 'since']);
+
+// 结果存储的默认位置（当前目录）
+const DEFAULT_STORE = 'cscan-results.bin';
+
+interface CliArgs {
+  positional: string[];
+  options: Map<string, string | true>;
+}
+
+function parseCliArgs(argv: string[]): CliArgs {
+  const positional: string[] = [];
+  const options = new Map<string, string | true>();
+
+  for (let i = 0; i < argv.length; i++) {
+    const arg = argv[i];
+    if (!arg.startsWith('--')) {
+      positional.push(arg);
+      continue;
+    }
+    const eq = arg.indexOf('=');
+    if (eq >= 0) {
+      options.set(arg.slice(2, eq), arg.slice(eq + 1));
+    } else if (VALUE_OPTIONS.has(arg.slice(2)) && i + 1 < argv.length) {
+      options.set(arg.slice(2), argv[++i]);
+    } else {
+      options.set(arg.slice(2), true);
+    }
+  }
+
+  return { positional, options };
+}
+
+/**
+ * --headers：头文件（.h）也作为独立的分析单元，每个只分析一次
+ */
+function sourceExtensions(args: CliArgs): string[] {
+  return args.options.has('headers') ? ['.c', '.h'] : ['.c'];
+}
+
+/**
+ * --configs：多个构建配置（JSON 文件或 "名称:宏,宏=值;名称:宏" 形式）
+ */
+async function buildConfigurations(args: CliArgs): Promise<BuildConfiguration[] | undefined> {
+  const spec = args.options.get('configs');
+  if (typeof spec !== 'string') return undefined;
+  const { parseConfigurations } = await import('../core/presence');
+  return parseConfigurations(spec);
+}
+
+function listCFiles(dir: string, extensions: string[] = ['.c']): string[] {
+  return fs.readdirSync(dir)
+    .filter(f => extensions.some(ext => f.endsWith(ext)))
+    .map(f => path.join(dir, f));
+}
+
+async function printHotspots(dir: string, limit: number) {
+  const { ComplexityEstimator } = await import('../core/complexity');
+  const estimator = new ComplexityEstimator();
+
+  for (const filePath of listCFiles(dir)) {
+    try {
+      estimator.addFile(filePath, fs.readFileSync(filePath, 'utf8'));
+    } catch (error) {
+      console.error(`分析文件 ${filePath} 时发生错误:`, error);
+    }
+  }
+
+  const ranked = estimator.rankHotspots();
+  console.log('\n=== 性能热点排名（静态复杂度估计）===');
+  ranked.slice(0, limit).forEach((func, i) => {
+    const relativePath = path.relative(process.cwd(), func.file);
+    const bounds = func.inputBoundLoops.map(loop => `${loop.line}(${loop.bound || '无界'})`).join(', ');
+    console.log(`${String(i + 1).padStart(3)}. ${func.orderLabel.padEnd(10)} ${relativePath}:${func.line} ${func.name}`);
+    console.log(`      最大循环嵌套 ${func.maxLoopDepth}${bounds ? `，输入规模循环: ${bounds}` : ''}`);
+  });
+  if (ranked.length > limit) {
+    console.log(`   ...(其余 ${ranked.length - limit} 个函数省略)`);
+  }
+}
+
+async function writeInstrumented(dir: string, outDir: string) {
+  const { SourceInstrumenter } = await import('../core/instrument');
+  const instrumenter = new SourceInstrumenter();
+  fs.mkdirSync(outDir, { recursive: true });
+
+  let total = 0;
+  for (const f of fs.readdirSync(dir)) {
+    const filePath = path.join(dir, f);
+    if (f.endsWith('.h')) {
+      fs.copyFileSync(filePath, path.join(outDir, f));
+    } else if (f.endsWith('.c')) {
+      try {
+        const result = instrumenter.instrument(filePath, fs.readFileSync(filePath, 'utf8'));
+        fs.writeFileSync(path.join(outDir, f), result.code, 'utf8');
+        total += result.sites.length;
+      } catch (error) {
+        console.error(`插桩文件 ${filePath} 时发生错误:`, error);
+      }
+    }
+  }
+  console.log(`\n已将插桩后的源码写入 ${outDir}（共 ${total} 个检查点），编译运行后用 --runtime-log 导入其标准错误输出`);
+}
+
+/**
+ * 用插桩程序的运行日志确认静态发现
+ */
+async function applyRuntimeLog(issues: Issue[], logFile: string): Promise<Issue[]> {
+  const { parseInstrumentationLog } = await import('../core/instrument');
+  const reports = parseInstrumentationLog(fs.readFileSync(logFile, 'utf8'));
+  const categoryOf = { 'uninitialized-read': 'Uninitialized', 'null-dereference': 'NullPointer' };
+
+  return issues.map((issue): Issue => {
+    if (issue.category !== 'Uninitialized' && issue.category !== 'NullPointer') {
+      return issue;
+    }
+    const confirmed = reports.some(report => categoryOf[report.kind] === issue.category && report.line === issue.line &&
+      path.basename(report.file) === path.basename(issue.file));
+    return { ...issue, confirmation: confirmed ? 'confirmed' : 'unconfirmed' };
+  });
+}
+
+/**
+ * cscan results query [--store 文件] [--category 类别] [--path 文件或目录] [--fingerprint 指纹] [--limit N] [--aggregate]
+ */
+async function runResultsCommand(args: CliArgs) {
+  if (args.positional[1] !== 'query') {
+    console.error('用法: cscan results query [--store 文件] [--category 类别] [--path 路径] [--fingerprint 指纹] [--limit N] [--aggregate]');
+    process.exit(2);
+  }
+
+  const { ResultStoreReader } = await import('../core/result_store');
+  const option = (name: string) => {
+    const value = args.options.get(name);
+    return typeof value === 'string' ? value : undefined;
+  };
+
+  const started = process.hrtime.bigint();
+  const reader = new ResultStoreReader(option('store') || DEFAULT_STORE);
+  try {
+    const targetPath = option('path');
+    const relativePath = targetPath !== undefined ? path.relative(reader.baseDirectory, path.resolve(targetPath)) : undefined;
+    const ids = reader.queryIds({ category: option('category'), path: relativePath, fingerprint: option('fingerprint') });
+    const limit = parseInt(option('limit') || '100', 10);
+
+    for (const id of ids.slice(0, limit)) {
+      const issue = reader.record(id);
+      const file = path.relative(process.cwd(), path.join(reader.baseDirectory, issue.file));
+      console.log(`${file}:${issue.line}: [${issue.category}] ${issue.message}`);
+      console.log(`    ${issue.codeLine}`);
+    }
+    if (ids.length > limit) {
+      console.log(`...(其余 ${ids.length - limit} 条省略，使用 --limit 调整)`);
+    }
+
+    if (args.options.has('aggregate')) {
+      const category = option('category');
+      console.log('\n=== 按目录汇总 ===');
+      for (const dir of reader.aggregate(relativePath || '')) {
+        const count = category ? (dir.byCategory[category] || 0) : dir.total;
+        const detail = category ? '' : '  ' + Object.entries(dir.byCategory).map(([name, n]) => `${name}=${n}`).join(' ');
+        console.log(`${String(count).padStart(8)}  ${dir.path || '.'}${detail}`);
+      }
+    }
+
+    const elapsed = Number(process.hrtime.bigint() - started) / 1e6;
+    console.log(`\n共 ${ids.length} 条匹配（${elapsed.toFixed(1)} ms）`);
+  } finally {
+    reader.close();
+  }
+}
+
+/**
+ * --format html：边扫描边写入 HTML 报告（默认输出到 ./cscan-report）
+ */
+async function writeHtmlReport(dir: string, args: CliArgs) {
+  const { HtmlReportWriter } = await import('../core/html_report');
+  const output = args.options.get('output');
+  const writer = new HtmlReportWriter(typeof output === 'string' ? output : 'cscan-report', dir);
+
+  let total = 0;
+  await analyzeDir(dir, (fileIssues) => {
+    for (const issue of fileIssues) {
+      writer.add(issue);
+    }
+    total += fileIssues.length;
+  }, sourceExtensions(args), await buildConfigurations(args));
+  const index = writer.finish();
+  console.log(`共 ${total} 个问题，HTML 报告已写入 ${path.relative(process.cwd(), index)}`);
+}
+
+/**
+ * --format arrow：边扫描边写入 Arrow IPC 流（默认输出到 ./cscan-results.arrow，--output - 为标准输出）
+ */
+async function writeArrowReport(dir: string, args: CliArgs) {
+  const { ArrowStreamWriter } = await import('../core/arrow_writer');
+  const output = args.options.get('output');
+  const target = typeof output === 'string' ? output : 'cscan-results.arrow';
+  const writer = new ArrowStreamWriter(target);
+
+  await analyzeDir(dir, (fileIssues) => writer.addFile(fileIssues), sourceExtensions(args), await buildConfigurations(args));
+  writer.finish();
+  if (target !== '-') {
+    console.log(`共 ${writer.rows} 个问题（${writer.batches} 个批次），Arrow 流已写入 ${path.relative(process.cwd(), path.resolve(target))}`);
+  }
+}
+
+/**
+ * --rev <commit>：从 git 对象库扫描指定提交中目录下的 .c 文件，结果按 blob ID 缓存
+ */
+async function analyzeRevision(dir: string, rev: string, cacheDir?: string, extensions: string[] = ['.c']): Promise<Issue[]> {
+  const { scanRevision } = await import('../core/revision_scan');
+  const { ResultCache } = await import('../core/result_cache');
+  const child_process = await import('child_process');
+
+  const repoDir = child_process.execFileSync('git', ['rev-parse', '--show-toplevel'], { cwd: dir, encoding: 'utf8' }).trim();
+  const pathPrefix = path.relative(repoDir, dir).split(path.sep).join('/');
+  const stats = { blobs: 0, cached: 0 };
+  const issues: Issue[] = [];
+  for await (const issue of scanRevision(repoDir, rev, { pathPrefix, extensions, cache: new ResultCache(cacheDir) }, stats)) {
+    issues.push(issue);
+  }
+  console.log(`${rev}: 共 ${stats.blobs} 个文件，其中 ${stats.cached} 个命中缓存`);
+  return issues;
+}
+
+/**
+ * cscan history-scan A..B [目录] [--cache-dir 目录]：给出范围内每个发现首次出现的提交
+ */
+async function runHistoryScan(args: CliArgs) {
+  const range = args.positional[1];
+  if (!range) {
+    console.error('用法: cscan history-scan <起点>..<终点> [目录] [--cache-dir 目录]');
+    process.exit(2);
+  }
+  const { scanHistory } = await import('../core/history_scan');
+  const { ResultCache } = await import('../core/result_cache');
+  const child_process = await import('child_process');
+
+  const dir = path.resolve(args.positional[2] || process.cwd());
+  const repoDir = child_process.execFileSync('git', ['rev-parse', '--show-toplevel'], { cwd: dir, encoding: 'utf8' }).trim();
+  const pathPrefix = path.relative(repoDir, dir).split(path.sep).join('/');
+  const cacheDir = args.options.get('cache-dir');
+  const result = await scanHistory(repoDir, range, {
+    pathPrefix,
+    extensions: sourceExtensions(args),
+    cache: new ResultCache(typeof cacheDir === 'string' ? cacheDir : undefined)
+  });
+
+  const order = new Map(result.commits.map((commit, index): [string, number] => [commit.id, index]));
+  const introduced = result.findings
+    .filter(finding => finding.introducedIn)
+    .sort((a, b) => order.get(a.introducedIn!.id)! - order.get(b.introducedIn!.id)!);
+
+  let lastCommit = '';
+  for (const finding of introduced) {
+    const commit = finding.introducedIn!;
+    if (commit.id !== lastCommit) {
+      console.log(`\n${commit.id.slice(0, 12)} ${commit.subject}`);
+      lastCommit = commit.id;
+    }
+    const issue = finding.issue;
+    const fixed = finding.fixedIn ? `  (已于 ${finding.fixedIn.id.slice(0, 12)} 消失)` : '';
+    console.log(`  ${path.relative(process.cwd(), issue.file)}:${issue.line}: [${issue.category}] ${issue.message}${fixed}`);
+  }
+
+  const byCategory = new Map<string, number>();
+  for (const finding of introduced) {
+    byCategory.set(finding.issue.category, (byCategory.get(finding.issue.category) || 0) + 1);
+  }
+  console.log('\n=== 范围内新引入的问题（按类别）===');
+  for (const [category, count] of byCategory) {
+    console.log(`${String(count).padStart(8)}  ${category}`);
+  }
+  console.log(`\n${result.commits.length} 个提交，${result.blobs} 个不同的 blob，其中 ${result.analyzed} 个需要分析；` +
+    `范围起点前已存在 ${result.findings.length - introduced.length} 个问题`);
+}
+
+/**
+ * cscan mentions <符号...> [目录] [--rev 提交]：列出提交中提到这些符号的文件（默认 HEAD）
+ * cscan mentions --since <基准> [目录] [--rev 提交]：符号取自基准以来定义发生变化的文件级定义，列出需要重新检查的文件
+ * 借助缓存条目中的标识符过滤器，只读取可能提到符号的文件
+ */
+async function runMentions(args: CliArgs) {
+  const since = args.options.get('since');
+  const names = typeof since === 'string' ? [] : (args.positional[1] || '').split(',').filter(name => name);
+  if (typeof since !== 'string' && names.length === 0) {
+    console.error('用法: cscan mentions <符号>[,<符号>...] [目录] [--rev 提交] [--cache-dir 目录]\n' +
+      '      cscan mentions --since <基准> [目录] [--rev 提交] [--cache-dir 目录]');
+    process.exit(2);
+  }
+  const { findAffected, findMentions } = await import('../core/mentions');
+  const { ResultCache } = await import('../core/result_cache');
+  const child_process = await import('child_process');
+
+  const dir = path.resolve(args.positional[typeof since === 'string' ? 1 : 2] || process.cwd());
+  const repoDir = child_process.execFileSync('git', ['rev-parse', '--show-toplevel'], { cwd: dir, encoding: 'utf8' }).trim();
+  const pathPrefix = path.relative(repoDir, dir).split(path.sep).join('/');
+  const rev = typeof args.options.get('rev') === 'string' ? args.options.get('rev') as string : 'HEAD';
+  const cacheDir = args.options.get('cache-dir');
+  const options = { pathPrefix, cache: new ResultCache(typeof cacheDir === 'string' ? cacheDir : undefined) };
+
+  let result;
+  if (typeof since === 'string') {
+    const affected = await findAffected(repoDir, since, rev, options);
+    console.log(`${since}..${rev}: ${affected.changed.length} 个文件有变化，` +
+      `${affected.definitions.length} 个定义发生变化${affected.definitions.length > 0 ? `: ${affected.definitions.join(', ')}` : ''}`);
+    if (!affected.mentions) return;
+    console.log('');
+    result = affected.mentions;
+    names.push(...affected.definitions);
+  } else {
+    result = await findMentions(repoDir, rev, names, options);
+  }
+
+  for (const file of result.files) {
+    const defines = file.defines.length > 0 ? `  (定义 ${file.defines.join(', ')})` : '';
+    console.log(`${path.relative(process.cwd(), path.join(repoDir, file.path))}${defines}`);
+  }
+  console.log(`\n${result.total} 个文件，过滤器筛出 ${result.candidates} 个候选` +
+    `（其中 ${result.unsummarized} 个没有缓存摘要），确认 ${result.files.length} 个提到 ${names.join(', ')}`);
+}
+
+/**
+ * cscan explain <指纹|文件:行> [--store 文件]：按需重建问题的见证路径
+ * 指纹在结果存储中查出文件与代码行；文件在扫描后有改动时按代码行重新定位到当前的行号
+ */
+async function runExplain(args: CliArgs) {
+  const target = args.positional[1] || '';
+  const fileLine = target.match(/^(.+):(\d+)$/);
+  if (!fileLine && !/^[0-9a-f]{16}$/i.test(target)) {
+    console.error('用法: cscan explain <指纹|文件:行> [--store 文件]');
+    process.exit(2);
+  }
+  const { WitnessExplainer } = await import('../core/witness');
+
+  const findings: Array<{ file: string; line: number; category: string; message: string; codeLine: string }> = [];
+  if (fileLine) {
+    const file = path.resolve(fileLine[1]);
+    const line = parseInt(fileLine[2], 10);
+    const { AnalysisEngine } = await import('../core/engine');
+    const issues = await new AnalysisEngine().analyzeSource(file, fs.readFileSync(file, 'utf8'));
+    findings.push(...issues.filter(issue => issue.line === line));
+  } else {
+    const { ResultStoreReader } = await import('../core/result_store');
+    const store = args.options.get('store');
+    const reader = new ResultStoreReader(typeof store === 'string' ? store : DEFAULT_STORE);
+    try {
+      for (const id of reader.queryIds({ fingerprint: target.toLowerCase() })) {
+        const issue = reader.record(id);
+        findings.push({ ...issue, file: path.join(reader.baseDirectory, issue.file) });
+      }
+    } finally {
+      reader.close();
+    }
+  }
+  if (findings.length === 0) {
+    console.error(`没有找到 ${target} 对应的问题`);
+    process.exitCode = 1;
+    return;
+  }
+
+  const explainer = new WitnessExplainer();
+  for (const finding of findings) {
+    const source = fs.readFileSync(finding.file, 'utf8');
+    const line = relocateLine(source.split('\n'), finding.line, finding.codeLine);
+    console.log(`${path.relative(process.cwd(), finding.file)}:${line}: [${finding.category}] ${finding.message}`);
+    const witness = explainer.explain(source, { line, message: finding.message });
+    if (!witness) {
+      console.log('    （该类问题没有见证路径）\n');
+      continue;
+    }
+    console.log(`    ${witness.summary}`);
+    for (const step of witness.steps) {
+      console.log(`    ${String(step.line).padStart(5)} | ${step.text}`);
+      console.log(`          ↳ ${step.note}`);
+    }
+    console.log('');
+  }
+}
+
+/**
+ * 在 line 附近找规范化后与 codeLine 相同的行（指纹与行号无关，扫描后代码可能上下移动）
+ */
+function relocateLine(sourceLines: string[], line: number, codeLine: string): number {
+  const normalize = (text: string) => text.replace(/\s+/g, ' ').trim();
+  const wanted = normalize(codeLine);
+  if (!wanted || normalize(sourceLines[line - 1] || '') === wanted) return line;
+  for (let distance = 1; distance < sourceLines.length; distance++) {
+    for (const candidate of [line - distance, line + distance]) {
+      if (candidate >= 1 && candidate <= sourceLines.length && normalize(sourceLines[candidate - 1]) === wanted) {
+        return candidate;
+      }
+    }
+  }
+  return line;
+}
+
+/**
+ * --staged：分析暂存区中即将提交的 .c 文件，只报告暂存行上的问题（用于 pre-commit 钩子，有问题时退出码为 1）
+ * 有 cscan daemon 在运行时交给它分析，省去加载解析器的时间
+ */
+async function runStaged(args: CliArgs) {
+  const started = process.hrtime.bigint();
+  const { readStagedFiles, inStagedRanges } = await import('../core/staged');
+  const { DaemonClient } = await import('../core/daemon_client');
+  const child_process = await import('child_process');
+
+  const repoDir = child_process.execFileSync('git', ['rev-parse', '--show-toplevel'], { encoding: 'utf8' }).trim();
+  const socket = args.options.get('socket');
+  const [files, client] = await Promise.all([
+    readStagedFiles(repoDir, sourceExtensions(args)),
+    DaemonClient.connect(typeof socket === 'string' ? socket : undefined)
+  ]);
+
+  // 本地头文件同样取暂存区中的版本，不读工作区
+  let analyze: (file: StagedFile) => Promise<Issue[]>;
+  if (client) {
+    analyze = (file) => client.analyze(path.join(repoDir, file.path), file.source, file.headers);
+  } else {
+    const { AnalysisEngine } = await import('../core/engine');
+    const engine = new AnalysisEngine();
+    analyze = (file) => engine.analyzeSource(path.join(repoDir, file.path), file.source, file.headers);
+  }
+
+  let total = 0;
+  try {
+    // daemon 按到达顺序处理同一连接上的请求，可以一次发出；进程内的引擎共用解析器和检测器状态，只能逐个分析
+    let results: Issue[][];
+    if (client) {
+      results = await Promise.all(files.map(file => analyze(file)));
+    } else {
+      results = [];
+      for (const file of files) {
+        results.push(await analyze(file));
+      }
+    }
+    files.forEach((file, i) => {
+      for (const issue of results[i]) {
+        if (!inStagedRanges(issue.line, file.ranges)) continue;
+        total++;
+        console.log(`${path.relative(process.cwd(), issue.file)}:${issue.line}: [${issue.category}] ${issue.message}`);
+        console.log(`    ${issue.codeLine.trim()}`);
+      }
+    });
+  } finally {
+    if (client) client.close();
+  }
+
+  const elapsed = Number(process.hrtime.bigint() - started) / 1e6;
+  console.log(`暂存区 ${files.length} 个文件，暂存行上 ${total} 个问题（${client ? 'daemon' : '进程内'}分析，${elapsed.toFixed(0)} ms）`);
+  if (total > 0) {
+    process.exitCode = 1;
+  }
+}
+
+/**
+ * cscan daemon [--socket 路径] [--metrics 端口|主机:端口|套接字路径]：常驻分析进程，供 --staged 等短命令复用已初始化的解析器
+ */
+async function runDaemon(args: CliArgs) {
+  const { startDaemon } = await import('../core/daemon');
+  const { defaultSocketPath } = await import('../core/daemon_client');
+  const { ResultCache } = await import('../core/result_cache');
+  const socket = args.options.get('socket');
+  const metrics = args.options.get('metrics');
+  const cacheDir = args.options.get('cache-dir');
+  const socketPath = typeof socket === 'string' ? socket : defaultSocketPath();
+  await startDaemon(socketPath, {
+    metrics: typeof metrics === 'string' ? metrics : undefined,
+    cache: new ResultCache(typeof cacheDir === 'string' ? cacheDir : undefined)
+  });
+  console.log(`cscan daemon 正在监听 ${socketPath}`);
+  if (typeof metrics === 'string') {
+    console.log(`指标端点: ${metrics} 上的 GET /metrics`);
+  }
+}
+
+/**
+ * --heap-profile[=目录]：目录扫描时按阶段（parse、各检测器、output）采样堆分配，默认写入 cscan-heap-profile/
+ */
+async function startHeapProfiler(args: CliArgs): Promise<HeapPhaseProfiler | undefined> {
+  const option = args.options.get('heap-profile');
+  if (!option) return undefined;
+  const { HeapPhaseProfiler } = await import('../core/heap_profile');
+  const profiler = new HeapPhaseProfiler(path.resolve(option === true ? 'cscan-heap-profile' : option));
+  await profiler.start();
+  return profiler;
+}
+
+/**
+ * 源码归档（.tar.gz 等）：流式读取其中的 .c/.h 条目并分析，不解压到磁盘，结果按内容哈希缓存
+ */
+async function analyzeArchive(archivePath: string, cacheDir?: string): Promise<Issue[]> {
+  const { scanArchive } = await import('../core/archive_scan');
+  const { ResultCache } = await import('../core/result_cache');
+
+  const stats = { files: 0, cached: 0, skipped: 0 };
+  const issues: Issue[] = [];
+  for await (const issue of scanArchive(archivePath, { cache: new ResultCache(cacheDir) }, stats)) {
+    issues.push(issue);
+  }
+  const skipped = stats.skipped > 0 ? `，${stats.skipped} 个过大的文件被跳过` : '';
+  console.log(`${path.basename(archivePath)}: 共 ${stats.files} 个源文件，其中 ${stats.cached} 个命中缓存${skipped}`);
+  return issues;
 }
 
 async function main() {
-  const dir = process.argv[2] ? path.resolve(process.argv[2]) : path.resolve(process.cwd(), 'samples');
+  const args = parseCliArgs(process.argv.slice(2));
+  if (args.positional[0] === 'results') {
+    await runResultsCommand(args);
+    return;
+  }
+  if (args.positional[0] === 'history-scan') {
+    await runHistoryScan(args);
+    return;
+  }
+  if (args.positional[0] === 'mentions') {
+    await runMentions(args);
+    return;
+  }
+  if (args.positional[0] === 'explain') {
+    await runExplain(args);
+    return;
+  }
+  if (args.positional[0] === 'daemon') {
+    await runDaemon(args);
+    return;
+  }
+  if (args.options.has('staged')) {
+    await runStaged(args);
+    return;
+  }
+  const dir = args.positional[0] ? path.resolve(args.positional[0]) : path.resolve(process.cwd(), 'samples');
+  const { isArchivePath } = await import('../core/tar_reader');
+  const archive = isArchivePath(dir) && fs.existsSync(dir) && fs.statSync(dir).isFile();
+
+  // 结果写到标准输出（--output -）时提示信息改走标准错误
+  const notice = args.options.get('output') === '-' ? console.error : console.log;
+  notice(archive ? `正在扫描归档: ${dir}` : `正在扫描目录: ${dir}`);
 
-  console.log(`正在扫描目录: ${dir}`);
+  if (args.options.get('format') === 'html') {
+    await writeHtmlReport(dir, args);
+    return;
+  }
+  if (args.options.get('format') === 'arrow') {
+    await writeArrowReport(dir, args);
+    return;
+  }
 
   try {
-    // 使用真正的AST分析
-    const issues = await analyzeDir(dir);
+    // 使用真正的AST分析；指定 --rev 时直接扫描 git 对象库中的该提交，参数为源码归档时流式扫描归档
+    const rev = args.options.get('rev');
+    const cacheDir = args.options.get('cache-dir');
+    const profiler = await startHeapProfiler(args);
+    let issues = typeof rev === 'string'
+      ? await analyzeRevision(args.positional[0] ? dir : process.cwd(), rev, typeof cacheDir === 'string' ? cacheDir : undefined,
+        sourceExtensions(args))
+      : archive
+        ? await analyzeArchive(dir, typeof cacheDir === 'string' ? cacheDir : undefined)
+        : await analyzeDir(dir, undefined, sourceExtensions(args), await buildConfigurations(args), profiler);
+
+    // 运行时确认：用 sanitizer 编译运行被报告的文件
+    if (args.options.has('confirm')) {
+      const { confirmFindings } = await import('../core/sanitizer');
+      const harness = args.options.get('harness');
+      issues = await confirmFindings(issues, { harness: typeof harness === 'string' ? harness : undefined });
+    }
+
+    // 运行时确认：导入插桩程序的运行日志
+    const runtimeLog = args.options.get('runtime-log');
+    if (typeof runtimeLog === 'string') {
+      issues = await applyRuntimeLog(issues, path.resolve(runtimeLog));
+    }
+
+    // 写入带索引的本地结果存储，供 cscan results query 查询
+    const store = args.options.get('store');
+    if (store) {
+      const { ResultStoreWriter } = await import('../core/result_store');
+      const writer = new ResultStoreWriter(store === true ? DEFAULT_STORE : store);
+      for (const issue of issues) {
+        writer.add(issue);
+      }
+      writer.finish();
+    }
+
+    // 运行时热度：插桩构建并执行用户命令，按所在函数的实测热度排序
+    const hotnessCommand = args.options.get('hotness');
+    if (typeof hotnessCommand === 'string' && issues.length > 0) {
+      const { measureHotness, rankIssuesByHotness } = await import('../core/hotness');
+      try {
+        issues = rankIssuesByHotness(issues, await measureHotness(dir, hotnessCommand));
+      } catch (error: any) {
+        console.warn('热度测量失败，保持原有顺序:', error.message);
+      }
+    }
 
+    if (profiler) await profiler.enter('output');
     if (issues.length === 0) {
       console.log('没有发现问题。');
     } else {
       printIssues(issues);
     }
+    if (profiler) {
+      await profiler.leave();
+      const profile = await profiler.finish();
+      console.log(`\n堆分析: ${profile.lines} 行源码的 AST 驻留约 ${(profile.retainedBytes / 1024).toFixed(0)} KB` +
+        `（${profile.lines > 0 ? (profile.retainedBytes * 1000 / profile.lines / 1024).toFixed(0) : 0} KB/KLOC），已写入 ${profile.files.length} 个文件到 ` +
+        `${path.dirname(profile.files[0])}`);
+    }
+
+    const instrumentDir = args.options.get('instrument');
+    if (typeof instrumentDir === 'string') {
+      await writeInstrumented(dir, path.resolve(instrumentDir));
+    }
+
+    const hotspots = args.options.get('hotspots');
+    if (hotspots) {
+      await printHotspots(dir, hotspots === true ? 20 : parseInt(hotspots, 10) || 20);
+    }
 
     printTables();
   } catch (error) {
@@ -1,5 +1,6 @@
 import * as vscode from 'vscode';
 import { analyzeWorkspaceCFiles } from '../core/scanner';
+import { WitnessExplainer } from '../core/witness';
 
 let diagnostics: vscode.DiagnosticCollection;
 
@@ -57,6 +58,25 @@ export function activate(context: vscode.ExtensionContext) {
   item.command = 'cscan.scanWorkspaceC';
   item.show();
   context.subscriptions.push(item);
+
+  // 悬停在扫描出的问题上时按需重建见证路径（只在悬停时解析当前文档，控制流图按内容缓存）
+  const explainer = new WitnessExplainer();
+  const hover = vscode.languages.registerHoverProvider({ language: 'c' }, {
+    provideHover(document, position) {
+      const found = (diagnostics.get(document.uri) || []).filter(diag => diag.range.contains(position));
+      const lines: string[] = [];
+      for (const diag of found) {
+        const witness = explainer.explain(document.getText(), { line: diag.range.start.line + 1, message: diag.message });
+        if (!witness) continue;
+        lines.push(`**见证路径**：${witness.summary}`, '');
+        for (const step of witness.steps) {
+          lines.push(`- 第 ${step.line} 行 \`${step.text.replace(/`/g, "'")}\`：${step.note}`);
+        }
+      }
+      return lines.length > 0 ? new vscode.Hover(new vscode.MarkdownString(lines.join('\n'))) : undefined;
+    }
+  });
+  context.subscriptions.push(hover);
 }
 
 export function deactivate() {
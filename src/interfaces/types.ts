@@ -1,11 +1,17 @@
 // 类型定义文件
 
+import { ASTNode } from '../core/ast_parser';
+
 export type Issue = {
   file: string;
   line: number;
   category: string;
   message: string;
   codeLine: string;
+  confirmation?: 'confirmed' | 'unconfirmed' | 'not-run'; // --confirm 运行时确认结果
+  hotness?: { function: string; calls: number; timeNs: number }; // --hotness 测得的所在函数热度
+  configurations?: string[];  // --configs 下该问题所在行存在的构建配置
+  presenceCondition?: string; // 所在行的 #if 存在条件（无条件时为空串）
 };
 
 export type VariableInfo = {
@@ -28,13 +34,19 @@ export interface MemoryAllocation {
 }
 
 export interface LoopInfo {
-  type: 'for' | 'while';
+  type: 'for' | 'while' | 'do';
   init?: string;
   condition: string;
   update?: string;
   line: number;
   hasBreak: boolean;
   hasReturn: boolean;
+  writtenVariables: Set<string>; // 循环体/条件/更新部分中可能被写入的变量
+  calledFunctions: string[];     // 循环内直接或嵌套调用的函数名
+  node: ASTNode;
+  body?: ASTNode;
+  conditionNode?: ASTNode;
+  updateNode?: ASTNode;
 }
 
 export interface TypeRange {
@@ -152,6 +152,35 @@ export const functionHeaderMap: { [key: string]: string } = {
   'localtime': 'time.h',
   'strftime': 'time.h',
   
+  // unistd.h / fcntl.h（POSIX 文件与进程）
+  'read': 'unistd.h',
+  'write': 'unistd.h',
+  'pread': 'unistd.h',
+  'pwrite': 'unistd.h',
+  'close': 'unistd.h',
+  'fsync': 'unistd.h',
+  'fdatasync': 'unistd.h',
+  'sleep': 'unistd.h',
+  'usleep': 'unistd.h',
+  'fork': 'unistd.h',
+  'open': 'fcntl.h',
+  'nanosleep': 'time.h',
+
+  // sys/socket.h、netdb.h、poll.h、sys/select.h（网络与 I/O 多路复用）
+  'socket': 'sys/socket.h',
+  'connect': 'sys/socket.h',
+  'accept': 'sys/socket.h',
+  'send': 'sys/socket.h',
+  'sendto': 'sys/socket.h',
+  'sendmsg': 'sys/socket.h',
+  'recv': 'sys/socket.h',
+  'recvfrom': 'sys/socket.h',
+  'recvmsg': 'sys/socket.h',
+  'getaddrinfo': 'netdb.h',
+  'gethostbyname': 'netdb.h',
+  'poll': 'poll.h',
+  'select': 'sys/select.h',
+
   // errno.h
   'perror': 'errno.h',
   
@@ -177,3 +206,60 @@ export const functionHeaderMap: { [key: string]: string } = {
   'LLONG_MIN': 'limits.h',
   'ULLONG_MAX': 'limits.h'
 };
+
+/**
+ * 纯函数表：结果只取决于实参（及实参指向的只读内存）的库函数
+ * 由上面的头文件映射派生：math.h / ctype.h 中的函数整体视为纯函数（frexp、modf 会写指针实参，除外），
+ * 其余头文件中只挑选只读的查询类函数
+ */
+const IMPURE_MATH_FUNCTIONS = new Set(['frexp', 'modf']);
+
+const CURATED_PURE_FUNCTIONS = [
+  // string.h（只读查询）
+  'strlen', 'strcmp', 'strncmp', 'strcasecmp', 'strncasecmp', 'strchr', 'strrchr',
+  'strstr', 'strpbrk', 'strspn', 'strcspn', 'memcmp', 'memchr', 'memmem', 'strcoll',
+  // stdlib.h
+  'abs', 'labs', 'llabs', 'atoi', 'atol', 'atoll', 'atof', 'getenv'
+];
+
+export const pureFunctions: Set<string> = new Set([
+  ...Object.keys(functionHeaderMap).filter(name => {
+    const header = functionHeaderMap[name];
+    return (header === 'math.h' || header === 'ctype.h') && !IMPURE_MATH_FUNCTIONS.has(name);
+  }),
+  ...CURATED_PURE_FUNCTIONS.filter(name => name in functionHeaderMap)
+]);
+
+/**
+ * 等待类库函数：休眠指定时间，或让出 CPU / 提示处理器正在自旋
+ * 不在上面的头文件映射中（unistd.h、sched.h 等不参与头文件检查），供忙等待检测器识别轮询循环
+ */
+export const sleepFunctions: Set<string> = new Set([
+  'sleep', 'usleep', 'nanosleep', 'clock_nanosleep', 'thrd_sleep', 'Sleep', 'SleepEx'
+]);
+
+export const spinHintFunctions: Set<string> = new Set([
+  'sched_yield', 'pthread_yield', 'thrd_yield', 'SwitchToThread',
+  '_mm_pause', '__builtin_ia32_pause', 'cpu_relax', 'YieldProcessor'
+]);
+
+/**
+ * 可能阻塞或耗时的库函数分类，按头文件映射判断：
+ * stdio.h（只读写内存的 sprintf/sscanf、只查询流状态的 feof 等除外）、unistd.h、fcntl.h 中的函数是文件/控制台 I/O，
+ * 网络与多路复用头文件中的函数是网络调用，另加休眠函数与 system
+ * 返回分类名；不会阻塞的函数返回 null
+ */
+const NON_BLOCKING_STDIO_FUNCTIONS = new Set(['sprintf', 'snprintf', 'sscanf', 'vsprintf', 'vsnprintf', 'vsscanf',
+  'tmpnam', 'setvbuf', 'setbuf', 'feof', 'ferror', 'clearerr']);
+const NETWORK_HEADERS = new Set(['sys/socket.h', 'netdb.h', 'poll.h', 'sys/select.h']);
+
+export function blockingCallKind(name: string): string | null {
+  if (sleepFunctions.has(name)) return '休眠';
+  if (name === 'system' || name === 'fork') return '进程创建';
+  const header = functionHeaderMap[name];
+  if (!header) return null;
+  if (NETWORK_HEADERS.has(header)) return '网络调用';
+  if (header === 'stdio.h' && !NON_BLOCKING_STDIO_FUNCTIONS.has(name)) return '文件/控制台 I/O';
+  if (header === 'unistd.h' || header === 'fcntl.h') return '文件 I/O';
+  return null;
+}
@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <ctype.h>
+#include <math.h>
+
+// 测试死存储与被丢弃的计算结果
+
+int lookup(int key) {
+    return key * 31 + 7;
+}
+
+int sum_positive(const int *values, int count) {
+    int total = lookup(count);            // BUG: 初始值在读取前总会被覆盖（死存储）
+    total = 0;
+    for (int i = 0; i < count; i++) {
+        if (values[i] > 0) {
+            total += values[i];
+        }
+    }
+    return total;
+}
+
+// 同名变量出现在不同的块中，应按各自的声明分别分析
+int shadowed(int n) {
+    {
+        int tmp = lookup(n);              // 应该不报错：在这个块中被读取
+        printf("tmp = %d\n", tmp);
+    }
+    {
+        int tmp = 0;                      // BUG: 这个块中的 tmp 只被写入、从未被读取
+        tmp = lookup(n + 1);
+    }
+    int level = lookup(n);
+    if (n > 0) {
+        int level = n * 2;                // 遮蔽外层的 level，在内层被读取
+        printf("inner level = %d\n", level);
+    }
+    return level;
+}
+
+int discarded(int c, double x) {
+    toupper(c);                           // BUG: 纯函数的返回值被忽略
+    sqrt(x);                              // BUG: 纯函数的返回值被忽略
+    c == 'a';                             // BUG: 比较结果被丢弃（本意可能是赋值）
+    int result = lookup(c);
+    result = lookup(result);
+    return result;
+}
+
+int main() {
+    int values[] = {3, -1, 4, -1, 5};
+    printf("%d\n", sum_positive(values, 5));
+    printf("%d\n", shadowed(2));
+    printf("%d\n", discarded('b', 2.0));
+    return 0;
+}
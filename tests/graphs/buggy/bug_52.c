@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include <pthread.h>
+
+// 测试临界区内的阻塞调用
+
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
+static char pending[256];
+static int pending_len;
+
+// 无条件循环：每轮加锁、写文件、解锁，应只报告一次
+void *log_writer(void *arg) {
+    FILE *out = (FILE *)arg;
+    for (;;) {
+        pthread_mutex_lock(&log_lock);
+        fwrite(pending, 1, (size_t)pending_len, out);   // BUG: 持有锁时做文件 I/O
+        pending_len = 0;
+        pthread_mutex_unlock(&log_lock);
+    }
+    return NULL;
+}
+
+// 先复制再解锁，I/O 在临界区之外，应该不报错
+void flush_copy(FILE *out) {
+    char copy[256];
+    int len;
+    pthread_mutex_lock(&log_lock);
+    len = pending_len;
+    for (int i = 0; i < len; i++) {
+        copy[i] = pending[i];
+    }
+    pending_len = 0;
+    pthread_mutex_unlock(&log_lock);
+    fwrite(copy, 1, (size_t)len, out);
+}
+
+// 持锁时在循环中累加，处理时间随 pending_len 增长
+int sum_locked(void) {
+    int total = 0;
+    pthread_mutex_lock(&log_lock);
+    for (int i = 0; i < pending_len; i++) {         // BUG: 临界区内执行次数取决于输入规模的循环
+        total += pending[i];
+    }
+    pthread_mutex_unlock(&log_lock);
+    return total;
+}
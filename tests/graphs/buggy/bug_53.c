@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <pthread.h>
+
+// 测试经辅助函数写入线程实参的伪共享
+
+struct stats {
+    long hits;
+    long misses;
+};
+
+static void count_hit(struct stats *st) {
+    st->hits++;
+}
+
+static void count_miss(struct stats *st) {
+    st->misses++;                         // BUG: 与 reader 线程写入的 hits 位于同一缓存行
+}
+
+void *reader(void *arg) {
+    struct stats *s = arg;
+    for (int i = 0; i < 1000; i++) {
+        count_hit(s);                     // 形参 st 指向线程实参
+    }
+    return NULL;
+}
+
+void *writer(void *arg) {
+    for (int i = 0; i < 1000; i++) {
+        count_miss((struct stats *)arg);  // 经类型转换传递同样指向线程实参
+    }
+    return NULL;
+}
+
+int main() {
+    struct stats shared = {0, 0};
+    pthread_t a, b;
+    pthread_create(&a, NULL, reader, &shared);
+    pthread_create(&b, NULL, writer, &shared);
+    pthread_join(a, NULL);
+    pthread_join(b, NULL);
+    printf("%ld %ld\n", shared.hits, shared.misses);
+    return 0;
+}